@@ -0,0 +1,60 @@
+BEGIN;
+
+ALTER TABLE pr_reviewers RENAME TO pr_reviewers_legacy;
+ALTER TABLE pull_requests RENAME TO pull_requests_legacy;
+
+-- A partitioned table's primary key must include the partition key, so the
+-- same id could exist in both partitions. Every PR id is registered here first;
+-- the unique key enforces one PR per id and deleting the id deletes the PR.
+CREATE TABLE pull_request_ids (
+    id VARCHAR(255) PRIMARY KEY
+);
+
+CREATE TABLE pull_requests (
+    id VARCHAR(255) NOT NULL REFERENCES pull_request_ids(id) ON DELETE CASCADE,
+    name VARCHAR(255) NOT NULL,
+    author_id VARCHAR(255) REFERENCES users(id),
+    status VARCHAR(50) DEFAULT 'OPEN',
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    merged_at TIMESTAMP,
+    archived BOOLEAN NOT NULL DEFAULT false,
+    PRIMARY KEY (id, archived)
+) PARTITION BY LIST (archived);
+
+CREATE TABLE pull_requests_active PARTITION OF pull_requests FOR VALUES IN (false);
+CREATE TABLE pull_requests_archive PARTITION OF pull_requests FOR VALUES IN (true);
+
+-- Reviewer rows follow their PR into the archive partition. The archiver moves
+-- pr_reviewers first, so the FK check is deferred to commit.
+CREATE TABLE pr_reviewers (
+    id SERIAL,
+    pr_id VARCHAR(255) NOT NULL,
+    reviewer_id VARCHAR(255) REFERENCES users(id),
+    assigned_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    archived BOOLEAN NOT NULL DEFAULT false,
+    PRIMARY KEY (id, archived),
+    UNIQUE (pr_id, reviewer_id, archived),
+    FOREIGN KEY (pr_id, archived) REFERENCES pull_requests(id, archived)
+        ON DELETE CASCADE DEFERRABLE INITIALLY DEFERRED
+) PARTITION BY LIST (archived);
+
+CREATE TABLE pr_reviewers_active PARTITION OF pr_reviewers FOR VALUES IN (false);
+CREATE TABLE pr_reviewers_archive PARTITION OF pr_reviewers FOR VALUES IN (true);
+
+INSERT INTO pull_request_ids (id) SELECT id FROM pull_requests_legacy;
+
+INSERT INTO pull_requests (id, name, author_id, status, created_at, merged_at)
+SELECT id, name, author_id, status, created_at, merged_at FROM pull_requests_legacy;
+
+INSERT INTO pr_reviewers (pr_id, reviewer_id, assigned_at)
+SELECT pr_id, reviewer_id, assigned_at FROM pr_reviewers_legacy;
+
+DROP TABLE pr_reviewers_legacy;
+DROP TABLE pull_requests_legacy;
+
+CREATE INDEX IF NOT EXISTS idx_pr_status ON pull_requests(status);
+CREATE INDEX IF NOT EXISTS idx_pr_author ON pull_requests(author_id);
+CREATE INDEX IF NOT EXISTS idx_pr_merged_at ON pull_requests(merged_at) WHERE status = 'MERGED';
+CREATE INDEX IF NOT EXISTS idx_pr_reviewers_reviewer ON pr_reviewers(reviewer_id);
+
+COMMIT;
@@ -0,0 +1,26 @@
+-- One row per event and webhook target: each target keeps its own attempts
+-- and backoff, and a target that accepted an event is never sent it again.
+CREATE TABLE IF NOT EXISTS review_outbox (
+    id BIGSERIAL PRIMARY KEY,
+    target VARCHAR(2048) NOT NULL,
+    event_type VARCHAR(50) NOT NULL,
+    user_id VARCHAR(255) NOT NULL,
+    pr_id VARCHAR(255) NOT NULL,
+    attempts INTEGER NOT NULL DEFAULT 0,
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    next_attempt_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+CREATE INDEX IF NOT EXISTS idx_review_outbox_next_attempt ON review_outbox(next_attempt_at, id);
+
+-- Deliveries that failed WEBHOOK_MAX_ATTEMPTS times.
+CREATE TABLE IF NOT EXISTS review_outbox_dead_letters (
+    id BIGINT PRIMARY KEY,
+    target VARCHAR(2048) NOT NULL,
+    event_type VARCHAR(50) NOT NULL,
+    user_id VARCHAR(255) NOT NULL,
+    pr_id VARCHAR(255) NOT NULL,
+    attempts INTEGER NOT NULL,
+    created_at TIMESTAMP,
+    failed_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
@@ -0,0 +1,81 @@
+CREATE SEQUENCE IF NOT EXISTS cache_invalidation_seq;
+
+-- Payload format: "<seq>:<kind>:<key>". Gaps in seq (rolled-back writes) are
+-- harmless; listeners resync fully only after reconnecting.
+CREATE OR REPLACE FUNCTION notify_cache_invalidation(kind TEXT, cache_key TEXT) RETURNS void AS $$
+BEGIN
+    IF cache_key IS NOT NULL THEN
+        PERFORM pg_notify('review_cache',
+            nextval('cache_invalidation_seq') || ':' || kind || ':' || cache_key);
+    END IF;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE FUNCTION users_cache_invalidation() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP IN ('UPDATE', 'DELETE') THEN
+        PERFORM notify_cache_invalidation('user', OLD.id);
+        PERFORM notify_cache_invalidation('team', (SELECT name FROM teams WHERE id = OLD.team_id));
+    END IF;
+    IF TG_OP IN ('INSERT', 'UPDATE') THEN
+        IF TG_OP = 'INSERT' OR NEW.team_id IS DISTINCT FROM OLD.team_id THEN
+            PERFORM notify_cache_invalidation('team', (SELECT name FROM teams WHERE id = NEW.team_id));
+        END IF;
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE FUNCTION pull_requests_cache_invalidation() RETURNS trigger AS $$
+DECLARE
+    reviewer RECORD;
+BEGIN
+    FOR reviewer IN SELECT reviewer_id FROM pr_reviewers WHERE pr_id = NEW.id LOOP
+        PERFORM notify_cache_invalidation('reviews', reviewer.reviewer_id);
+    END LOOP;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Response bodies are cached by data version, and not every pull_requests
+-- change touches a reviewer (a merge without reviewers, a new PR), so any
+-- statement on the table bumps the version on every node.
+CREATE OR REPLACE FUNCTION pull_requests_write_notification() RETURNS trigger AS $$
+BEGIN
+    PERFORM notify_cache_invalidation('write', TG_TABLE_NAME);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE FUNCTION pr_reviewers_cache_invalidation() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        PERFORM notify_cache_invalidation('reviews', OLD.reviewer_id);
+    ELSE
+        PERFORM notify_cache_invalidation('reviews', NEW.reviewer_id);
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS users_cache_invalidation ON users;
+CREATE TRIGGER users_cache_invalidation
+    AFTER INSERT OR UPDATE OR DELETE ON users
+    FOR EACH ROW EXECUTE FUNCTION users_cache_invalidation();
+
+-- Only status changes are visible in cached review lists. Archive moves are
+-- skipped: pr_reviewers rows move with them and notify on their own.
+DROP TRIGGER IF EXISTS pull_requests_cache_invalidation ON pull_requests;
+CREATE TRIGGER pull_requests_cache_invalidation
+    AFTER UPDATE OF status, name ON pull_requests
+    FOR EACH ROW EXECUTE FUNCTION pull_requests_cache_invalidation();
+
+DROP TRIGGER IF EXISTS pull_requests_write_notification ON pull_requests;
+CREATE TRIGGER pull_requests_write_notification
+    AFTER INSERT OR UPDATE OR DELETE ON pull_requests
+    FOR EACH STATEMENT EXECUTE FUNCTION pull_requests_write_notification();
+
+DROP TRIGGER IF EXISTS pr_reviewers_cache_invalidation ON pr_reviewers;
+CREATE TRIGGER pr_reviewers_cache_invalidation
+    AFTER INSERT OR UPDATE OR DELETE ON pr_reviewers
+    FOR EACH ROW EXECUTE FUNCTION pr_reviewers_cache_invalidation();
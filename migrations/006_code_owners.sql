@@ -0,0 +1,11 @@
+CREATE TABLE IF NOT EXISTS code_owners (
+    id SERIAL PRIMARY KEY,
+    pattern VARCHAR(1024) NOT NULL,
+    owner_id VARCHAR(255) NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- Tables created before the column was made mandatory.
+ALTER TABLE code_owners ALTER COLUMN owner_id SET NOT NULL;
+
+CREATE INDEX IF NOT EXISTS idx_code_owners_owner ON code_owners(owner_id);
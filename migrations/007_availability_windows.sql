@@ -0,0 +1,29 @@
+CREATE TABLE IF NOT EXISTS availability_windows (
+    id BIGSERIAL PRIMARY KEY,
+    user_id VARCHAR(255) NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+    starts_at TIMESTAMP NOT NULL,
+    ends_at TIMESTAMP NOT NULL,
+    reason VARCHAR(255),
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    CHECK (ends_at > starts_at)
+);
+
+CREATE INDEX IF NOT EXISTS idx_availability_windows_user ON availability_windows(user_id);
+CREATE INDEX IF NOT EXISTS idx_availability_windows_ends_at ON availability_windows(ends_at);
+
+-- Other nodes reload the user's windows on "availability:<user_id>".
+CREATE OR REPLACE FUNCTION availability_windows_cache_invalidation() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        PERFORM notify_cache_invalidation('availability', OLD.user_id);
+    ELSE
+        PERFORM notify_cache_invalidation('availability', NEW.user_id);
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS availability_windows_cache_invalidation ON availability_windows;
+CREATE TRIGGER availability_windows_cache_invalidation
+    AFTER INSERT OR UPDATE OR DELETE ON availability_windows
+    FOR EACH ROW EXECUTE FUNCTION availability_windows_cache_invalidation();
@@ -0,0 +1,15 @@
+-- Directory of team placements. It is read from the primary (shard 0) only;
+-- on other shards the table stays empty.
+CREATE TABLE IF NOT EXISTS team_shards (
+    team_name VARCHAR(255) PRIMARY KEY,
+    shard_id INTEGER NOT NULL DEFAULT 0,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- Teams created before sharding live on the primary.
+INSERT INTO team_shards (team_name, shard_id)
+SELECT name, 0 FROM teams
+ON CONFLICT (team_name) DO NOTHING;
+
+-- Code owners stay on the primary while their users may live on any shard.
+ALTER TABLE code_owners DROP CONSTRAINT IF EXISTS code_owners_owner_id_fkey;
@@ -0,0 +1,15 @@
+-- Review events for the SLA aggregates of every instance. Sent from the
+-- writing transaction, so listeners only see events of committed writes.
+-- Payload: "<type>\t<user_id>\t<pr_id>\t<team>\t<epoch_ms>"; the team is the
+-- user's team at write time, so listeners never have to look it up.
+CREATE OR REPLACE FUNCTION notify_review_event(event_type TEXT, reviewer TEXT, pull_request TEXT)
+RETURNS void AS $$
+BEGIN
+    PERFORM pg_notify('review_events', concat_ws(E'\t',
+        event_type,
+        reviewer,
+        pull_request,
+        COALESCE((SELECT t.name FROM users u JOIN teams t ON t.id = u.team_id WHERE u.id = reviewer), ''),
+        floor(extract(epoch FROM now()) * 1000)::bigint));
+END;
+$$ LANGUAGE plpgsql;
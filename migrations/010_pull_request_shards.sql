@@ -0,0 +1,14 @@
+-- Directory of PR placements, kept on the primary (shard 0) like team_shards.
+-- Its key is what makes a PR id unique across shards: a create claims the id
+-- here in the same commit as the PR itself. No FK to pull_request_ids, since
+-- the PR may live on another shard.
+CREATE TABLE IF NOT EXISTS pull_request_shards (
+    pull_request_id VARCHAR(255) PRIMARY KEY,
+    shard_id INTEGER NOT NULL DEFAULT 0
+);
+
+-- PRs created before the directory on the primary. Those on other shards are
+-- recorded when a lookup first finds them by probing.
+INSERT INTO pull_request_shards (pull_request_id, shard_id)
+SELECT id, 0 FROM pull_request_ids
+ON CONFLICT (pull_request_id) DO NOTHING;
@@ -0,0 +1,72 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+// Quantile sketch with relative-error guarantees (DDSketch). Values are
+// counted in logarithmic bins, so any quantile is within relativeAccuracy of
+// the true value and two sketches merge by adding bin counts.
+class DDSketch {
+public:
+    explicit DDSketch(double relativeAccuracy = 0.01, size_t maxBins = 2048)
+        : gamma_((1 + relativeAccuracy) / (1 - relativeAccuracy)),
+          logGamma_(std::log(gamma_)),
+          maxBins_(maxBins) {}
+
+    void add(double value) {
+        count_++;
+        if (value <= MIN_VALUE) {
+            zeroCount_++;
+            return;
+        }
+        bins_[static_cast<int>(std::ceil(std::log(value) / logGamma_))]++;
+        collapse();
+    }
+
+    void merge(const DDSketch& other) {
+        count_ += other.count_;
+        zeroCount_ += other.zeroCount_;
+        for (const auto& [index, count] : other.bins_) {
+            bins_[index] += count;
+        }
+        collapse();
+    }
+
+    uint64_t count() const { return count_; }
+
+    double quantile(double q) const {
+        if (count_ == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * (count_ - 1));
+        if (rank < zeroCount_) return 0;
+        uint64_t seen = zeroCount_;
+        for (const auto& [index, count] : bins_) {
+            seen += count;
+            if (seen > rank) {
+                return 2 * std::pow(gamma_, index) / (gamma_ + 1);
+            }
+        }
+        return 2 * std::pow(gamma_, bins_.rbegin()->first) / (gamma_ + 1);
+    }
+
+private:
+    static constexpr double MIN_VALUE = 1e-9;
+
+    double gamma_;
+    double logGamma_;
+    size_t maxBins_;
+    uint64_t count_ = 0;
+    uint64_t zeroCount_ = 0;
+    std::map<int, uint64_t> bins_;
+
+    // Folds the lowest bins together once the limit is hit; high quantiles,
+    // the ones an SLA cares about, keep their accuracy.
+    void collapse() {
+        while (bins_.size() > maxBins_) {
+            auto lowest = bins_.begin();
+            auto next = std::next(lowest);
+            next->second += lowest->second;
+            bins_.erase(lowest);
+        }
+    }
+};
@@ -0,0 +1,148 @@
+#include "ReviewAnalytics.h"
+#include <algorithm>
+
+int64_t ReviewAnalytics::hourOf(TimePoint time) {
+    return std::chrono::duration_cast<std::chrono::hours>(time.time_since_epoch()).count();
+}
+
+ReviewAnalytics::Bucket* ReviewAnalytics::bucketFor(TimePoint time) {
+    int64_t hour = hourOf(time);
+    Bucket& bucket = buckets_[hour % MAX_WINDOW_HOURS];
+    if (bucket.hour > hour) {
+        return nullptr;
+    }
+    if (bucket.hour != hour) {
+        bucket.hour = hour;
+        bucket.teams.clear();
+        bucket.userAssignments.clear();
+    }
+    return &bucket;
+}
+
+void ReviewAnalytics::trackOpened(const std::string& prId, TimePoint openedAt) {
+    if (openedAt_.emplace(prId, openedAt).second) {
+        openedOrder_.emplace(openedAt, prId);
+    }
+}
+
+void ReviewAnalytics::expireOpened(TimePoint now) {
+    while (!openedOrder_.empty() &&
+           (openedOrder_.size() > maxOpenPullRequests_ || openedOrder_.begin()->first < now - maxOpenAge_)) {
+        openedAt_.erase(openedOrder_.begin()->second);
+        openedOrder_.erase(openedOrder_.begin());
+    }
+}
+
+void ReviewAnalytics::seedOpenReview(const std::string& prId, const std::string& reviewerId,
+                                     const std::string& teamName, TimePoint openedAt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    userTeam_[reviewerId] = teamName;
+    openReviews_[reviewerId]++;
+    trackOpened(prId, openedAt);
+    expireOpened(std::chrono::system_clock::now());
+}
+
+void ReviewAnalytics::record(const ReviewEvent& event, const std::string& teamName) {
+    if (event.type == ReviewEventType::RESYNC) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!teamName.empty()) {
+        userTeam_[event.user_id] = teamName;
+    }
+    const std::string& team = userTeam_[event.user_id];
+    int& open = openReviews_[event.user_id];
+
+    switch (event.type) {
+        case ReviewEventType::ASSIGNED: {
+            open++;
+            trackOpened(event.pr_id, event.occurred_at);
+            expireOpened(event.occurred_at);
+            if (Bucket* bucket = bucketFor(event.occurred_at)) {
+                bucket->teams[team].assignments++;
+                bucket->userAssignments[event.user_id]++;
+            }
+            break;
+        }
+        case ReviewEventType::UNASSIGNED:
+            open = std::max(0, open - 1);
+            break;
+        case ReviewEventType::MERGED: {
+            open = std::max(0, open - 1);
+            // One MERGED event per reviewer; the first one closes the PR.
+            auto it = openedAt_.find(event.pr_id);
+            if (it != openedAt_.end()) {
+                double seconds = std::chrono::duration<double>(event.occurred_at - it->second).count();
+                if (Bucket* bucket = bucketFor(event.occurred_at)) {
+                    TeamBucket& teamBucket = bucket->teams[team];
+                    teamBucket.merges++;
+                    teamBucket.latency.add(std::max(0.0, seconds));
+                }
+                openedOrder_.erase({it->second, it->first});
+                openedAt_.erase(it);
+            }
+            break;
+        }
+        case ReviewEventType::RESYNC:
+            break;
+    }
+}
+
+size_t ReviewAnalytics::trackedOpenPullRequests() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return openedAt_.size();
+}
+
+SlaReport ReviewAnalytics::report(const std::string& team, int windowHours) const {
+    SlaReport report;
+    report.team = team;
+    report.windowHours = std::clamp(windowHours, 1, MAX_WINDOW_HOURS);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto inTeam = [&](const std::string& userId) {
+        if (team.empty()) return true;
+        auto it = userTeam_.find(userId);
+        return it != userTeam_.end() && it->second == team;
+    };
+
+    DDSketch latency;
+    std::unordered_map<std::string, uint64_t> userAssignments;
+    int64_t now = hourOf(std::chrono::system_clock::now());
+    for (int64_t hour = now - report.windowHours + 1; hour <= now; hour++) {
+        const Bucket& bucket = buckets_[hour % MAX_WINDOW_HOURS];
+        uint64_t assignments = 0;
+        if (bucket.hour == hour) {
+            for (const auto& [teamName, teamBucket] : bucket.teams) {
+                if (!team.empty() && teamName != team) continue;
+                assignments += teamBucket.assignments;
+                report.merges += teamBucket.merges;
+                latency.merge(teamBucket.latency);
+            }
+            for (const auto& [userId, count] : bucket.userAssignments) {
+                if (inTeam(userId)) userAssignments[userId] += count;
+            }
+        }
+        report.assignments += assignments;
+        report.assignmentsPerHour.push_back(assignments);
+    }
+
+    report.latencySamples = latency.count();
+    report.latencyP50 = latency.quantile(0.5);
+    report.latencyP90 = latency.quantile(0.9);
+    report.latencyP99 = latency.quantile(0.99);
+
+    for (const auto& [userId, open] : openReviews_) {
+        if (!inTeam(userId)) continue;
+        report.openReviews += open;
+        auto assigned = userAssignments.find(userId);
+        if (open > 0 || assigned != userAssignments.end()) {
+            ReviewerLoad load;
+            load.user_id = userId;
+            load.open_reviews = open;
+            load.assignments = assigned != userAssignments.end() ? assigned->second : 0;
+            report.reviewers.push_back(load);
+        }
+    }
+    std::sort(report.reviewers.begin(), report.reviewers.end(),
+        [](const ReviewerLoad& a, const ReviewerLoad& b) { return a.open_reviews > b.open_reviews; });
+    return report;
+}
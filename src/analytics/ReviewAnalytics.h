@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "DDSketch.h"
+#include "../models/ReviewEvent.h"
+
+struct ReviewerLoad {
+    std::string user_id;
+    int open_reviews = 0;
+    uint64_t assignments = 0;
+};
+
+struct SlaReport {
+    std::string team;
+    int windowHours = 0;
+    uint64_t assignments = 0;
+    uint64_t merges = 0;
+    std::vector<uint64_t> assignmentsPerHour;
+    uint64_t latencySamples = 0;
+    double latencyP50 = 0;
+    double latencyP90 = 0;
+    double latencyP99 = 0;
+    int openReviews = 0;
+    std::vector<ReviewerLoad> reviewers;
+};
+
+// Rolling review SLA aggregates fed from review events of every instance
+// (the review_events channel). Assignments, merges and merge-latency sketches
+// are kept in hourly buckets per team; open-review counts are live gauges.
+// Reports merge the buckets in the requested window, so no query ever scans
+// assignment history. Open times are kept for at most maxOpenPullRequests
+// PRs and maxOpenAge; a PR merged after its entry was dropped has no latency
+// sample.
+class ReviewAnalytics {
+public:
+    static constexpr int MAX_WINDOW_HOURS = 7 * 24;
+
+    explicit ReviewAnalytics(size_t maxOpenPullRequests = 100000,
+                             std::chrono::hours maxOpenAge = std::chrono::hours(30 * 24))
+        : buckets_(MAX_WINDOW_HOURS), maxOpenPullRequests_(maxOpenPullRequests), maxOpenAge_(maxOpenAge) {}
+
+    // Open state at startup: one call per open (PR, reviewer) pair.
+    void seedOpenReview(const std::string& prId, const std::string& reviewerId, const std::string& teamName,
+                        std::chrono::system_clock::time_point openedAt);
+
+    // teamName is the reviewer's team at the time of the event.
+    void record(const ReviewEvent& event, const std::string& teamName);
+
+    size_t trackedOpenPullRequests() const;
+
+    // Empty team means all teams.
+    SlaReport report(const std::string& team, int windowHours) const;
+
+private:
+    struct TeamBucket {
+        uint64_t assignments = 0;
+        uint64_t merges = 0;
+        DDSketch latency;
+    };
+
+    struct Bucket {
+        int64_t hour = -1;
+        std::unordered_map<std::string, TeamBucket> teams;
+        std::unordered_map<std::string, uint64_t> userAssignments;
+    };
+
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    std::vector<Bucket> buckets_;
+    std::unordered_map<std::string, std::string> userTeam_;
+    std::unordered_map<std::string, int> openReviews_;
+    std::unordered_map<std::string, TimePoint> openedAt_;
+    // Same entries ordered by open time, oldest first, for expiry.
+    std::set<std::pair<TimePoint, std::string>> openedOrder_;
+    size_t maxOpenPullRequests_;
+    std::chrono::hours maxOpenAge_;
+    mutable std::mutex mutex_;
+
+    static int64_t hourOf(TimePoint time);
+    Bucket* bucketFor(TimePoint time);
+    void trackOpened(const std::string& prId, TimePoint openedAt);
+    void expireOpened(TimePoint now);
+};
@@ -0,0 +1,183 @@
+#include "AvailabilityIndex.h"
+#include <algorithm>
+#include <mutex>
+
+IntervalTree::IntervalTree(std::vector<AvailabilityWindow> windows) : windows_(std::move(windows)) {
+    windows_.erase(std::remove_if(windows_.begin(), windows_.end(), [](const AvailabilityWindow& window) {
+        return window.ends_at <= window.starts_at;
+    }), windows_.end());
+    std::vector<uint32_t> indices(windows_.size());
+    for (uint32_t i = 0; i < indices.size(); i++) {
+        indices[i] = i;
+    }
+    nodes_.reserve(windows_.size());
+    root_ = build(std::move(indices));
+}
+
+int IntervalTree::build(std::vector<uint32_t> indices) {
+    if (indices.empty()) return -1;
+
+    // The median start is inside its own window, so every node keeps at
+    // least one window and the recursion terminates.
+    auto middle = indices.begin() + indices.size() / 2;
+    std::nth_element(indices.begin(), middle, indices.end(), [this](uint32_t a, uint32_t b) {
+        return windows_[a].starts_at < windows_[b].starts_at;
+    });
+    TimePoint center = windows_[*middle].starts_at;
+
+    std::vector<uint32_t> left;
+    std::vector<uint32_t> right;
+    Node node;
+    node.center = center;
+    for (uint32_t i : indices) {
+        if (windows_[i].ends_at <= center) {
+            left.push_back(i);
+        } else if (windows_[i].starts_at > center) {
+            right.push_back(i);
+        } else {
+            node.byStart.push_back(i);
+        }
+    }
+    node.byEnd = node.byStart;
+    std::sort(node.byStart.begin(), node.byStart.end(), [this](uint32_t a, uint32_t b) {
+        return windows_[a].starts_at < windows_[b].starts_at;
+    });
+    std::sort(node.byEnd.begin(), node.byEnd.end(), [this](uint32_t a, uint32_t b) {
+        return windows_[a].ends_at > windows_[b].ends_at;
+    });
+
+    int index = static_cast<int>(nodes_.size());
+    nodes_.push_back(std::move(node));
+    int leftIndex = build(std::move(left));
+    int rightIndex = build(std::move(right));
+    nodes_[index].left = leftIndex;
+    nodes_[index].right = rightIndex;
+    return index;
+}
+
+void AvailabilityIndex::replaceAll(const std::vector<AvailabilityWindow>& windows) {
+    std::unordered_map<std::string, std::vector<AvailabilityWindow>> byTeam;
+    for (const auto& window : windows) {
+        byTeam[window.team_name].push_back(window);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    trees_.clear();
+    userTeam_.clear();
+    for (auto& [teamName, teamWindows] : byTeam) {
+        for (const auto& window : teamWindows) {
+            userTeam_[window.user_id] = teamName;
+        }
+        rebuild(teamName, std::move(teamWindows));
+    }
+}
+
+void AvailabilityIndex::replaceUsers(const std::vector<std::string>& userIds,
+                                     const std::vector<AvailabilityWindow>& windows) {
+    std::unordered_set<std::string> users(userIds.begin(), userIds.end());
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::unordered_set<std::string> teams;
+    for (const auto& userId : userIds) {
+        auto it = userTeam_.find(userId);
+        if (it != userTeam_.end()) {
+            teams.insert(it->second);
+            userTeam_.erase(it);
+        }
+    }
+    for (const auto& window : windows) {
+        teams.insert(window.team_name);
+        userTeam_[window.user_id] = window.team_name;
+    }
+
+    for (const auto& teamName : teams) {
+        std::vector<AvailabilityWindow> kept;
+        for (auto& window : windowsOf(teamName)) {
+            if (!users.count(window.user_id)) {
+                kept.push_back(std::move(window));
+            }
+        }
+        for (const auto& window : windows) {
+            if (window.team_name == teamName) {
+                kept.push_back(window);
+            }
+        }
+        rebuild(teamName, std::move(kept));
+    }
+}
+
+void AvailabilityIndex::moveUser(const std::string& userId, const std::string& teamName) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = userTeam_.find(userId);
+    if (it == userTeam_.end() || it->second == teamName) return;
+
+    std::string oldTeam = it->second;
+    it->second = teamName;
+    std::vector<AvailabilityWindow> kept;
+    std::vector<AvailabilityWindow> moved = windowsOf(teamName);
+    for (auto& window : windowsOf(oldTeam)) {
+        if (window.user_id == userId) {
+            window.team_name = teamName;
+            moved.push_back(std::move(window));
+        } else {
+            kept.push_back(std::move(window));
+        }
+    }
+    rebuild(oldTeam, std::move(kept));
+    rebuild(teamName, std::move(moved));
+}
+
+std::unordered_set<std::string> AvailabilityIndex::unavailableAt(const std::string& teamName, TimePoint time) {
+    std::shared_ptr<const IntervalTree> tree;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = trees_.find(teamName);
+        if (it != trees_.end()) {
+            tree = it->second;
+        }
+    }
+    lookups_++;
+
+    std::unordered_set<std::string> users;
+    if (tree) {
+        tree->stab(time, [&users](const AvailabilityWindow& window) { users.insert(window.user_id); });
+    }
+    filtered_ += users.size();
+    return users;
+}
+
+std::vector<AvailabilityWindow> AvailabilityIndex::teamWindows(const std::string& teamName) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return windowsOf(teamName);
+}
+
+AvailabilityStats AvailabilityIndex::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    AvailabilityStats stats;
+    stats.teams = trees_.size();
+    for (const auto& [teamName, tree] : trees_) {
+        stats.windows += tree->windows().size();
+    }
+    stats.lookups = lookups_;
+    stats.filtered = filtered_;
+    stats.rebuilds = rebuilds_;
+    return stats;
+}
+
+void AvailabilityIndex::rebuild(const std::string& teamName, std::vector<AvailabilityWindow> windows) {
+    auto now = std::chrono::system_clock::now();
+    windows.erase(std::remove_if(windows.begin(), windows.end(), [now](const AvailabilityWindow& window) {
+        return window.ends_at <= now;
+    }), windows.end());
+    if (windows.empty()) {
+        trees_.erase(teamName);
+    } else {
+        trees_[teamName] = std::make_shared<const IntervalTree>(std::move(windows));
+    }
+    rebuilds_++;
+}
+
+std::vector<AvailabilityWindow> AvailabilityIndex::windowsOf(const std::string& teamName) const {
+    auto it = trees_.find(teamName);
+    return it == trees_.end() ? std::vector<AvailabilityWindow>() : it->second->windows();
+}
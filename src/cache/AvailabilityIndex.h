@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../models/AvailabilityWindow.h"
+
+// Static centered interval tree. Each node keeps the windows that contain its
+// center, sorted by start and by end, so a point query walks one root-to-leaf
+// path and only touches windows it reports: O(log n + k).
+class IntervalTree {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    explicit IntervalTree(std::vector<AvailabilityWindow> windows);
+
+    template <typename Visitor>
+    void stab(TimePoint time, Visitor&& visit) const {
+        int nodeIndex = root_;
+        while (nodeIndex != -1) {
+            const Node& node = nodes_[nodeIndex];
+            if (time < node.center) {
+                for (uint32_t i : node.byStart) {
+                    if (windows_[i].starts_at > time) break;
+                    visit(windows_[i]);
+                }
+                nodeIndex = node.left;
+            } else {
+                for (uint32_t i : node.byEnd) {
+                    if (windows_[i].ends_at <= time) break;
+                    visit(windows_[i]);
+                }
+                nodeIndex = node.right;
+            }
+        }
+    }
+
+    const std::vector<AvailabilityWindow>& windows() const { return windows_; }
+
+private:
+    struct Node {
+        TimePoint center;
+        std::vector<uint32_t> byStart;
+        std::vector<uint32_t> byEnd;
+        int left = -1;
+        int right = -1;
+    };
+
+    std::vector<AvailabilityWindow> windows_;
+    std::vector<Node> nodes_;
+    int root_ = -1;
+
+    int build(std::vector<uint32_t> indices);
+};
+
+struct AvailabilityStats {
+    size_t windows = 0;
+    size_t teams = 0;
+    uint64_t lookups = 0;
+    uint64_t filtered = 0;
+    uint64_t rebuilds = 0;
+};
+
+// Scheduled unavailability per team. Writers rebuild one team's tree and swap
+// it in; readers only hold the lock long enough to copy the pointer.
+class AvailabilityIndex {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    void replaceAll(const std::vector<AvailabilityWindow>& windows);
+    // Drops every window of userIds, then adds windows (which may only belong to them).
+    void replaceUsers(const std::vector<std::string>& userIds, const std::vector<AvailabilityWindow>& windows);
+    void moveUser(const std::string& userId, const std::string& teamName);
+
+    std::unordered_set<std::string> unavailableAt(const std::string& teamName, TimePoint time);
+    std::vector<AvailabilityWindow> teamWindows(const std::string& teamName) const;
+
+    AvailabilityStats stats() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const IntervalTree>> trees_;
+    std::unordered_map<std::string, std::string> userTeam_;
+
+    std::atomic<uint64_t> lookups_{0};
+    std::atomic<uint64_t> filtered_{0};
+    std::atomic<uint64_t> rebuilds_{0};
+
+    void rebuild(const std::string& teamName, std::vector<AvailabilityWindow> windows);
+    std::vector<AvailabilityWindow> windowsOf(const std::string& teamName) const;
+};
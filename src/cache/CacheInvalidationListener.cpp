@@ -0,0 +1,200 @@
+#include "CacheInvalidationListener.h"
+#include "../database/ReplicaRouter.h"
+#include "../database/RowDecoder.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/select.h>
+#include <vector>
+
+CacheInvalidationListener::~CacheInvalidationListener() {
+    stop();
+}
+
+void CacheInvalidationListener::start() {
+    if (worker_.joinable()) return;
+    stopping_ = false;
+    worker_ = std::thread(&CacheInvalidationListener::run, this);
+}
+
+void CacheInvalidationListener::stop() {
+    stopping_ = true;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+InvalidationListenerStats CacheInvalidationListener::stats() const {
+    InvalidationListenerStats stats;
+    stats.received = received_;
+    stats.resyncs = resyncs_;
+    stats.lastSequence = lastSequence_;
+    stats.connected = connected_;
+    return stats;
+}
+
+PGconn* CacheInvalidationListener::listen() {
+    PGconn* conn = PQconnectdb(connectionString_.c_str());
+    if (PQstatus(conn) != CONNECTION_OK) {
+        PQfinish(conn);
+        return nullptr;
+    }
+    PGresult* res = PQexec(conn, "LISTEN review_cache; LISTEN review_events");
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    if (!success) {
+        PQfinish(conn);
+        return nullptr;
+    }
+    return conn;
+}
+
+void CacheInvalidationListener::resync(const char* reason) {
+    std::cerr << "Cache invalidation resync: " << reason << std::endl;
+    cache_.clear();
+    if (availabilityObserver_) {
+        availabilityObserver_("");
+    }
+    if (shardObserver_) {
+        shardObserver_("");
+    }
+    resyncs_++;
+}
+
+void CacheInvalidationListener::apply(const char* payload) {
+    const char* firstColon = std::strchr(payload, ':');
+    if (!firstColon) return;
+    const char* secondColon = std::strchr(firstColon + 1, ':');
+    if (!secondColon) return;
+
+    uint64_t seq = std::strtoull(payload, nullptr, 10);
+    std::string kind(firstColon + 1, secondColon);
+    std::string key(secondColon + 1);
+
+    if (kind == "team") {
+        cache_.invalidateTeam(key);
+    } else if (kind == "user") {
+        cache_.invalidateUser(key);
+    } else if (kind == "availability") {
+        if (availabilityObserver_) {
+            availabilityObserver_(key);
+        }
+    } else if (kind == "reviews") {
+        cache_.invalidateReviews(key);
+    } else if (kind == "write") {
+        cache_.noteWrite();
+    } else if (kind == "shard") {
+        cache_.invalidateTeam(key);
+        if (shardObserver_) {
+            shardObserver_(key);
+        }
+    }
+    received_++;
+    if (seq > lastSequence_) {
+        lastSequence_ = seq;
+    }
+}
+
+void CacheInvalidationListener::applyEvent(const char* payload) {
+    if (!eventObserver_) return;
+    // "<type>\t<user_id>\t<pr_id>\t<team>\t<epoch_ms>"
+    std::vector<std::string> fields;
+    const char* start = payload;
+    while (true) {
+        const char* tab = std::strchr(start, '\t');
+        fields.emplace_back(start, tab ? tab : start + std::strlen(start));
+        if (!tab) break;
+        start = tab + 1;
+    }
+    if (fields.size() != 5) return;
+
+    ReviewEventType type;
+    if (fields[0] == "ASSIGNED") {
+        type = ReviewEventType::ASSIGNED;
+    } else if (fields[0] == "UNASSIGNED") {
+        type = ReviewEventType::UNASSIGNED;
+    } else if (fields[0] == "MERGED") {
+        type = ReviewEventType::MERGED;
+    } else {
+        return;
+    }
+    ReviewEvent event(type, fields[1], fields[2]);
+    event.occurred_at = std::chrono::system_clock::time_point(
+        std::chrono::milliseconds(std::strtoll(fields[4].c_str(), nullptr, 10)));
+    eventObserver_(event, fields[3]);
+}
+
+void CacheInvalidationListener::reportPrimaryLsn(PGconn* conn) {
+    if (!writeObserver_) return;
+    PGresult* res = PQexecParams(conn, "SELECT pg_current_wal_lsn()",
+                                 0, nullptr, nullptr, nullptr, nullptr, RowDecoder::BINARY);
+    if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
+        writeObserver_(RowDecoder(res, 0).lsn(0));
+    }
+    PQclear(res);
+}
+
+void CacheInvalidationListener::run() {
+    PGconn* conn = nullptr;
+    bool everConnected = false;
+    auto retryDelay = std::chrono::milliseconds(100);
+
+    while (!stopping_) {
+        if (!conn) {
+            conn = listen();
+            if (!conn) {
+                std::this_thread::sleep_for(retryDelay);
+                retryDelay = std::min(retryDelay * 2, std::chrono::milliseconds(5000));
+                continue;
+            }
+            retryDelay = std::chrono::milliseconds(100);
+            connected_ = true;
+            if (everConnected) {
+                // Anything published while we were not listening is lost.
+                resync("listener reconnected");
+            }
+            everConnected = true;
+        }
+
+        int socket = PQsocket(conn);
+        if (socket < 0) {
+            PQfinish(conn);
+            conn = nullptr;
+            connected_ = false;
+            continue;
+        }
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(socket, &readable);
+        timeval timeout{0, 100000};
+        int ready = select(socket + 1, &readable, nullptr, nullptr, &timeout);
+
+        if (ready > 0 && !PQconsumeInput(conn)) {
+            std::cerr << "Cache invalidation listener lost connection: "
+                      << PQerrorMessage(conn) << std::endl;
+            PQfinish(conn);
+            conn = nullptr;
+            connected_ = false;
+            continue;
+        }
+
+        bool received = false;
+        while (PGnotify* notify = PQnotifies(conn)) {
+            if (std::strcmp(notify->relname, "review_events") == 0) {
+                applyEvent(notify->extra);
+            } else {
+                apply(notify->extra);
+            }
+            PQfreemem(notify);
+            received = true;
+        }
+        if (received) {
+            reportPrimaryLsn(conn);
+        }
+    }
+
+    if (conn) {
+        PQfinish(conn);
+    }
+    connected_ = false;
+}
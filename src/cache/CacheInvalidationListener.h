@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <libpq-fe.h>
+#include "ReviewCache.h"
+#include "../models/ReviewEvent.h"
+
+struct InvalidationListenerStats {
+    uint64_t received = 0;
+    uint64_t resyncs = 0;
+    uint64_t lastSequence = 0;
+    bool connected = false;
+};
+
+// Applies cache invalidations published by the database triggers on the
+// review_cache channel, so every node drops entries written by any other node.
+// Each notification is applied on its own, so gaps in the sequence (rolled-back
+// writes, out-of-order commits) need no action; only notifications missed
+// while disconnected do, and those are covered by a resync on reconnect.
+class CacheInvalidationListener {
+public:
+    using WriteObserver = std::function<void(uint64_t lsn)>;
+    using AvailabilityObserver = std::function<void(const std::string& userId)>;
+    using ShardObserver = std::function<void(const std::string& teamName)>;
+    using EventObserver = std::function<void(const ReviewEvent& event, const std::string& teamName)>;
+
+    CacheInvalidationListener(const std::string& connectionString, ReviewCache& cache)
+        : connectionString_(connectionString), cache_(cache) {}
+    ~CacheInvalidationListener();
+
+    // Called with the primary's WAL position after each batch of remote
+    // invalidations, so replica reads can be held back until they catch up.
+    void setWriteObserver(WriteObserver observer) { writeObserver_ = std::move(observer); }
+    // Called when a user's availability windows changed on any node; an empty
+    // id after a resync means "reload everyone".
+    void setAvailabilityObserver(AvailabilityObserver observer) { availabilityObserver_ = std::move(observer); }
+    // Called when a team moved to another shard; empty after a resync.
+    void setShardObserver(ShardObserver observer) { shardObserver_ = std::move(observer); }
+    // Called for every committed review event (review_events channel); events
+    // sent while disconnected are not replayed.
+    void setEventObserver(EventObserver observer) { eventObserver_ = std::move(observer); }
+
+    void start();
+    void stop();
+
+    InvalidationListenerStats stats() const;
+
+private:
+    std::string connectionString_;
+    ReviewCache& cache_;
+    WriteObserver writeObserver_;
+    AvailabilityObserver availabilityObserver_;
+    ShardObserver shardObserver_;
+    EventObserver eventObserver_;
+
+    std::thread worker_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> connected_{false};
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> resyncs_{0};
+    std::atomic<uint64_t> lastSequence_{0};
+
+    void run();
+    PGconn* listen();
+    void apply(const char* payload);
+    void applyEvent(const char* payload);
+    void resync(const char* reason);
+    void reportPrimaryLsn(PGconn* conn);
+};
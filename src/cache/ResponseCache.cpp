@@ -0,0 +1,167 @@
+#include "ResponseCache.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <zlib.h>
+
+namespace {
+
+std::string trim(const std::string& value) {
+    size_t first = value.find_first_not_of(" \t");
+    if (first == std::string::npos) return "";
+    size_t last = value.find_last_not_of(" \t");
+    return value.substr(first, last - first + 1);
+}
+
+// Raw deflate stream (no zlib or gzip framing).
+bool deflateRaw(const std::string& input, int level, std::string& output) {
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    output.resize(deflateBound(&stream, input.size()));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+    int rc = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return rc == Z_STREAM_END;
+}
+
+void appendLittleEndian(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+void appendBigEndian(std::string& out, uint32_t value) {
+    for (int i = 3; i >= 0; i--) {
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+}
+
+const std::string& EncodedResponse::body() const {
+    switch (encoding) {
+        case ContentEncoding::GZIP: return entry->gzip;
+        case ContentEncoding::DEFLATE: return entry->deflate;
+        default: return entry->raw;
+    }
+}
+
+ContentEncoding ResponseCache::negotiate(const std::string& acceptEncoding) {
+    double gzipQ = -1;
+    double deflateQ = -1;
+    double anyQ = 0;
+    size_t start = 0;
+    while (start <= acceptEncoding.size()) {
+        size_t end = acceptEncoding.find(',', start);
+        if (end == std::string::npos) end = acceptEncoding.size();
+        std::string item = acceptEncoding.substr(start, end - start);
+        start = end + 1;
+
+        double q = 1;
+        size_t semicolon = item.find(';');
+        if (semicolon != std::string::npos) {
+            std::string param = trim(item.substr(semicolon + 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                q = std::strtod(param.c_str() + 2, nullptr);
+            }
+            item = item.substr(0, semicolon);
+        }
+        std::string coding = trim(item);
+        std::transform(coding.begin(), coding.end(), coding.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        if (coding == "gzip" || coding == "x-gzip") {
+            gzipQ = q;
+        } else if (coding == "deflate") {
+            deflateQ = q;
+        } else if (coding == "*") {
+            anyQ = q;
+        }
+    }
+    // "*" covers the codings that are not listed explicitly.
+    if (gzipQ < 0) gzipQ = anyQ;
+    if (deflateQ < 0) deflateQ = anyQ;
+    if (gzipQ > 0 && gzipQ >= deflateQ) return ContentEncoding::GZIP;
+    if (deflateQ > 0) return ContentEncoding::DEFLATE;
+    return ContentEncoding::IDENTITY;
+}
+
+const char* ResponseCache::encodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::GZIP: return "gzip";
+        case ContentEncoding::DEFLATE: return "deflate";
+        default: return "identity";
+    }
+}
+
+EncodedResponse ResponseCache::get(const std::string& key, uint64_t version, ContentEncoding accepted) {
+    auto entry = entries_.get(key);
+    if (!entry || (*entry)->version != version) {
+        misses_++;
+        return {};
+    }
+    hits_++;
+    return serve(std::move(*entry), accepted);
+}
+
+EncodedResponse ResponseCache::put(const std::string& key, std::string raw, uint64_t version,
+                                   ContentEncoding accepted) {
+    auto entry = std::make_shared<CachedResponse>();
+    entry->version = version;
+    entry->raw = std::move(raw);
+
+    std::string stream;
+    if (level_ > 0 && entry->raw.size() >= minCompressBytes_ && deflateRaw(entry->raw, level_, stream)) {
+        const auto* input = reinterpret_cast<const Bytef*>(entry->raw.data());
+        uInt size = static_cast<uInt>(entry->raw.size());
+
+        // RFC 1952: fixed 10-byte header, then CRC-32 and input size.
+        entry->gzip.assign("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+        entry->gzip += stream;
+        appendLittleEndian(entry->gzip, crc32(crc32(0L, Z_NULL, 0), input, size));
+        appendLittleEndian(entry->gzip, static_cast<uint32_t>(entry->raw.size()));
+
+        // RFC 1950 (what HTTP calls deflate): 32K window header, then Adler-32.
+        entry->deflate.assign("\x78\x9c", 2);
+        entry->deflate += stream;
+        appendBigEndian(entry->deflate, adler32(adler32(0L, Z_NULL, 0), input, size));
+
+        compressions_++;
+        rawBytes_ += entry->raw.size();
+        compressedBytes_ += stream.size();
+    }
+
+    entries_.put(key, entry);
+    return serve(std::move(entry), accepted);
+}
+
+EncodedResponse ResponseCache::serve(std::shared_ptr<const CachedResponse> entry, ContentEncoding accepted) {
+    EncodedResponse response;
+    response.encoding = entry->compressed() ? accepted : ContentEncoding::IDENTITY;
+    response.entry = std::move(entry);
+    switch (response.encoding) {
+        case ContentEncoding::GZIP: servedGzip_++; break;
+        case ContentEncoding::DEFLATE: servedDeflate_++; break;
+        default: servedIdentity_++; break;
+    }
+    return response;
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    ResponseCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.compressions = compressions_;
+    stats.rawBytes = rawBytes_;
+    stats.compressedBytes = compressedBytes_;
+    stats.servedIdentity = servedIdentity_;
+    stats.servedGzip = servedGzip_;
+    stats.servedDeflate = servedDeflate_;
+    stats.entries = entries_.size();
+    return stats;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include "LruCache.h"
+
+enum class ContentEncoding { IDENTITY, GZIP, DEFLATE };
+
+// One rendered body plus its gzip and deflate forms. Both are built from a
+// single raw deflate stream, so a fill costs one compression. Bodies below
+// the size threshold are kept uncompressed only.
+struct CachedResponse {
+    uint64_t version = 0;
+    std::string raw;
+    std::string gzip;
+    std::string deflate;
+
+    bool compressed() const { return !gzip.empty(); }
+};
+
+struct EncodedResponse {
+    std::shared_ptr<const CachedResponse> entry;
+    ContentEncoding encoding = ContentEncoding::IDENTITY;
+
+    explicit operator bool() const { return entry != nullptr; }
+    const std::string& body() const;
+};
+
+struct ResponseCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t compressions = 0;
+    uint64_t rawBytes = 0;
+    uint64_t compressedBytes = 0;
+    uint64_t servedIdentity = 0;
+    uint64_t servedGzip = 0;
+    uint64_t servedDeflate = 0;
+    size_t entries = 0;
+};
+
+// Rendered JSON of large read endpoints. An entry is only served while the
+// data version it was filled at (ReviewCache::version()) is still current, so
+// any write makes every entry stale; stale entries are replaced on the next
+// fill or fall out of the LRU.
+class ResponseCache {
+public:
+    ResponseCache(size_t capacity = 1000, size_t minCompressBytes = 1024, int level = 6)
+        : entries_(capacity), minCompressBytes_(minCompressBytes), level_(level) {}
+
+    static ContentEncoding negotiate(const std::string& acceptEncoding);
+    static const char* encodingName(ContentEncoding encoding);
+
+    EncodedResponse get(const std::string& key, uint64_t version, ContentEncoding accepted);
+    // version is the one observed before the data was read.
+    EncodedResponse put(const std::string& key, std::string raw, uint64_t version, ContentEncoding accepted);
+
+    ResponseCacheStats stats() const;
+
+private:
+    LruCache<std::string, std::shared_ptr<const CachedResponse>> entries_;
+    size_t minCompressBytes_;
+    int level_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> compressions_{0};
+    std::atomic<uint64_t> rawBytes_{0};
+    std::atomic<uint64_t> compressedBytes_{0};
+    std::atomic<uint64_t> servedIdentity_{0};
+    std::atomic<uint64_t> servedGzip_{0};
+    std::atomic<uint64_t> servedDeflate_{0};
+
+    EncodedResponse serve(std::shared_ptr<const CachedResponse> entry, ContentEncoding accepted);
+};
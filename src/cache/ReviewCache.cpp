@@ -0,0 +1,144 @@
+#include "ReviewCache.h"
+#include <functional>
+
+size_t ReviewCache::slot(const std::string& key) {
+    return std::hash<std::string>{}(key) % kStampSlots;
+}
+
+bool ReviewCache::teamChangedSince(const std::string& teamName, uint64_t version) const {
+    return teamsEpoch_ > version || teamStamps_[slot(teamName)] > version;
+}
+
+bool ReviewCache::reviewsChangedSince(const std::string& userId, uint64_t version) const {
+    return reviewsEpoch_ > version || reviewStamps_[slot(userId)] > version;
+}
+
+std::optional<Team> ReviewCache::getTeam(const std::string& teamName) {
+    auto team = teams_.get(teamName);
+    team ? hits_++ : misses_++;
+    return team;
+}
+
+void ReviewCache::putTeam(const Team& team, uint64_t sinceVersion) {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    if (teamChangedSince(team.name, sinceVersion)) return;
+    storeTeam(team);
+}
+
+void ReviewCache::storeTeam(const Team& team) {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        for (const auto& member : team.members) {
+            userTeam_[member.id] = team.name;
+        }
+    }
+    teams_.put(team.name, team);
+}
+
+void ReviewCache::invalidateTeam(const std::string& teamName) {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    teamStamps_[slot(teamName)] = ++version_;
+    teams_.erase(teamName);
+}
+
+void ReviewCache::noteWrite() {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    version_++;
+}
+
+void ReviewCache::invalidateUser(const std::string& userId) {
+    std::string teamName;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        auto it = userTeam_.find(userId);
+        if (it != userTeam_.end()) {
+            teamName = it->second;
+            userTeam_.erase(it);
+        }
+    }
+    if (teamName.empty()) {
+        // The user's team is unknown here (e.g. its roster is still being
+        // loaded by a fill or the warm-up), so no roster read before this
+        // write can be trusted.
+        std::lock_guard<std::mutex> lock(invalidationMutex_);
+        teamsEpoch_ = ++version_;
+        return;
+    }
+    invalidateTeam(teamName);
+}
+
+std::optional<std::vector<PullRequest>> ReviewCache::getReviews(const std::string& userId) {
+    auto prs = reviews_.get(userId);
+    prs ? hits_++ : misses_++;
+    return prs;
+}
+
+void ReviewCache::putReviews(const std::string& userId, std::vector<PullRequest> prs, uint64_t sinceVersion) {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    if (reviewsChangedSince(userId, sinceVersion)) return;
+    reviews_.put(userId, std::move(prs));
+}
+
+void ReviewCache::invalidateReviews(const std::string& userId) {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    reviewStamps_[slot(userId)] = ++version_;
+    reviews_.erase(userId);
+}
+
+std::optional<int> ReviewCache::openReviewCount(const std::string& userId) {
+    auto prs = getReviews(userId);
+    if (!prs) return std::nullopt;
+    int count = 0;
+    for (const auto& pr : *prs) {
+        if (!pr.isMerged()) count++;
+    }
+    return count;
+}
+
+bool ReviewCache::copyReviews(const std::string& userId, bool openOnly,
+                              std::pmr::vector<PullRequestSummary>& out) {
+    bool hit = reviews_.visit(userId, [&](const std::vector<PullRequest>& prs) {
+        for (const auto& pr : prs) {
+            if (!openOnly || !pr.isMerged()) {
+                out.emplace_back(pr.id, pr.name, pr.author_id, pr.status);
+            }
+        }
+    });
+    if (hit) hits_++;
+    return hit;
+}
+
+void ReviewCache::beginWarmup() {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    warmupVersion_ = version_;
+}
+
+void ReviewCache::putTeamFromWarmup(const Team& team) {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    if (teamChangedSince(team.name, warmupVersion_)) return;
+    storeTeam(team);
+}
+
+void ReviewCache::putReviewsFromWarmup(const std::string& userId, std::vector<PullRequest> prs) {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    if (reviewsChangedSince(userId, warmupVersion_)) return;
+    reviews_.put(userId, std::move(prs));
+}
+
+void ReviewCache::clear() {
+    std::lock_guard<std::mutex> lock(invalidationMutex_);
+    teamsEpoch_ = reviewsEpoch_ = ++version_;
+    teams_.clear();
+    reviews_.clear();
+    std::lock_guard<std::mutex> indexLock(indexMutex_);
+    userTeam_.clear();
+}
+
+ReviewCacheStats ReviewCache::stats() const {
+    ReviewCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.teams = teams_.size();
+    stats.reviewLists = reviews_.size();
+    return stats;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LruCache.h"
+#include "../models/User.h"
+#include "../models/PullRequest.h"
+
+struct ReviewCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t teams = 0;
+    size_t reviewLists = 0;
+};
+
+// Team rosters and per-reviewer review lists (archived PRs included). Database keeps
+// it coherent by invalidating on every write that touches a cached key; other
+// nodes' writes arrive through CacheInvalidationListener. Read-through fills
+// pass the version observed before querying and are dropped only if their own
+// key (or a key sharing its stamp slot) was invalidated in between.
+class ReviewCache {
+public:
+    ReviewCache(size_t teamCapacity = 10000, size_t reviewCapacity = 100000)
+        : teams_(teamCapacity), reviews_(reviewCapacity) {}
+
+    uint64_t version() const { return version_; }
+    // Advances the version for writes that touch no cached key, so that
+    // version-keyed responses (ResponseCache) still see them.
+    void noteWrite();
+
+    std::optional<Team> getTeam(const std::string& teamName);
+    void putTeam(const Team& team, uint64_t sinceVersion);
+    void invalidateTeam(const std::string& teamName);
+    void invalidateUser(const std::string& userId);
+
+    std::optional<std::vector<PullRequest>> getReviews(const std::string& userId);
+    void putReviews(const std::string& userId, std::vector<PullRequest> prs, uint64_t sinceVersion);
+    void invalidateReviews(const std::string& userId);
+    std::optional<int> openReviewCount(const std::string& userId);
+    bool copyReviews(const std::string& userId, bool openOnly, std::pmr::vector<PullRequestSummary>& out);
+
+    // The bulk loader's snapshot is as old as beginWarmup(), so keys
+    // invalidated since then are not overwritten with it.
+    void beginWarmup();
+    void putTeamFromWarmup(const Team& team);
+    void putReviewsFromWarmup(const std::string& userId, std::vector<PullRequest> prs);
+
+    void clear();
+    ReviewCacheStats stats() const;
+
+private:
+    LruCache<std::string, Team> teams_;
+    LruCache<std::string, std::vector<PullRequest>> reviews_;
+
+    std::mutex indexMutex_;
+    std::unordered_map<std::string, std::string> userTeam_;
+
+    // Each invalidation stamps its key's slot with a fresh version; a fill is
+    // stale if its slot (or the epoch, for invalidations of every key) was
+    // stamped after the version it read at.
+    static constexpr size_t kStampSlots = 4096;
+
+    std::mutex invalidationMutex_;
+    std::atomic<uint64_t> version_{0};
+    std::vector<uint64_t> teamStamps_ = std::vector<uint64_t>(kStampSlots, 0);
+    std::vector<uint64_t> reviewStamps_ = std::vector<uint64_t>(kStampSlots, 0);
+    uint64_t teamsEpoch_ = 0;
+    uint64_t reviewsEpoch_ = 0;
+    uint64_t warmupVersion_ = 0;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+
+    static size_t slot(const std::string& key);
+    bool teamChangedSince(const std::string& teamName, uint64_t version) const;
+    bool reviewsChangedSince(const std::string& userId, uint64_t version) const;
+    void storeTeam(const Team& team);
+};
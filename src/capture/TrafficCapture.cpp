@@ -0,0 +1,240 @@
+#include "TrafficCapture.h"
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+// The last digit is the format version.
+const char MAGIC[8] = {'P', 'R', 'C', 'A', 'P', '0', '0', '2'};
+const size_t MAGIC_PREFIX = 7;
+
+uint64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void putString(std::string& out, const std::string& value) {
+    putVarint(out, value.size());
+    out += value;
+}
+
+void encode(std::string& out, const CapturedRequest& request) {
+    putVarint(out, request.offsetUs);
+    putVarint(out, request.latencyUs);
+    putVarint(out, request.status);
+    putString(out, request.method);
+    putString(out, request.path);
+    putString(out, request.query);
+    putString(out, request.body);
+    putString(out, request.idempotencyKey);
+    putString(out, request.minLsn);
+}
+
+}
+
+TrafficCapture::TrafficCapture(const std::string& path, size_t queueCapacity, uint64_t rngSeed)
+    : path_(path), queueCapacity_(queueCapacity), rngSeed_(rngSeed) {}
+
+TrafficCapture::~TrafficCapture() {
+    stop();
+}
+
+bool TrafficCapture::start() {
+    if (writer_.joinable()) return true;
+    if (!resume()) return false;
+    file_ = std::fopen(path_.c_str(), "ab");
+    if (!file_) {
+        std::cerr << "Cannot open capture file " << path_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (bytes_ == 0) {
+        startedUs_ = nowUs();
+        std::string header(MAGIC, sizeof(MAGIC));
+        putVarint(header, startedUs_);
+        putVarint(header, rngSeed_);
+        std::fwrite(header.data(), 1, header.size(), file_);
+        std::fflush(file_);
+        bytes_ = header.size();
+    }
+
+    stopping_ = false;
+    writer_ = std::thread(&TrafficCapture::run, this);
+    return true;
+}
+
+// Leaves bytes_ at 0 for a new or empty file, otherwise at the end of the
+// last complete record, with startedUs_ set so offsets carry on from it.
+bool TrafficCapture::resume() {
+    bytes_ = 0;
+    std::FILE* existing = std::fopen(path_.c_str(), "rb");
+    if (!existing) return true;
+    std::fseek(existing, 0, SEEK_END);
+    long size = std::ftell(existing);
+    std::fclose(existing);
+    if (size <= 0) return true;
+
+    CaptureReader reader;
+    if (!reader.open(path_) || !reader.current()) {
+        std::cerr << "Capture file " << path_ << " is not a capture in the current format, "
+                  << "move it away to start a new one" << std::endl;
+        return false;
+    }
+    uint64_t lastOffset = 0;
+    CapturedRequest request;
+    while (reader.next(request)) {
+        lastOffset = std::max(lastOffset, request.offsetUs);
+    }
+    if (reader.position() < size && ::truncate(path_.c_str(), reader.position()) != 0) {
+        std::cerr << "Cannot cut the incomplete last record off " << path_ << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (reader.rngSeed() != rngSeed_) {
+        std::cerr << "Warning: capture " << path_ << " was started with REVIEWER_RNG_SEED="
+                  << reader.rngSeed() << ", appending with " << rngSeed_ << std::endl;
+    }
+    startedUs_ = nowUs() - lastOffset;
+    bytes_ = static_cast<uint64_t>(reader.position());
+    return true;
+}
+
+void TrafficCapture::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+uint64_t TrafficCapture::elapsedUs() const {
+    return nowUs() - startedUs_;
+}
+
+void TrafficCapture::record(CapturedRequest&& request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || !file_) return;
+        if (queue_.size() >= queueCapacity_) {
+            dropped_++;
+            return;
+        }
+        queue_.push_back(std::move(request));
+    }
+    wakeup_.notify_one();
+}
+
+TrafficCaptureStats TrafficCapture::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TrafficCaptureStats stats;
+    stats.recorded = recorded_;
+    stats.dropped = dropped_;
+    stats.bytes = bytes_;
+    return stats;
+}
+
+void TrafficCapture::run() {
+    std::vector<CapturedRequest> batch;
+    std::string buffer;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeup_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) break;
+            batch.swap(queue_);
+        }
+
+        buffer.clear();
+        for (const auto& request : batch) {
+            encode(buffer, request);
+        }
+        bool written = std::fwrite(buffer.data(), 1, buffer.size(), file_) == buffer.size();
+        std::fflush(file_);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (written) {
+            recorded_ += batch.size();
+            bytes_ += buffer.size();
+        } else {
+            dropped_ += batch.size();
+        }
+        batch.clear();
+    }
+}
+
+CaptureReader::~CaptureReader() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool CaptureReader::open(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) return false;
+    char magic[sizeof(MAGIC)];
+    if (std::fread(magic, 1, sizeof(magic), file_) != sizeof(magic) ||
+        std::memcmp(magic, MAGIC, MAGIC_PREFIX) != 0) {
+        return false;
+    }
+    version_ = magic[MAGIC_PREFIX] - '0';
+    if (version_ < 1 || version_ > CURRENT_VERSION || !readVarint(startedUs_) || !readVarint(rngSeed_)) {
+        return false;
+    }
+    position_ = std::ftell(file_);
+    return true;
+}
+
+bool CaptureReader::next(CapturedRequest& request) {
+    uint64_t latency = 0;
+    uint64_t status = 0;
+    if (!readVarint(request.offsetUs) || !readVarint(latency) || !readVarint(status) ||
+        !readString(request.method) || !readString(request.path) || !readString(request.query) ||
+        !readString(request.body)) {
+        return false;
+    }
+    request.idempotencyKey.clear();
+    request.minLsn.clear();
+    if (version_ >= 2 && (!readString(request.idempotencyKey) || !readString(request.minLsn))) {
+        return false;
+    }
+    request.latencyUs = static_cast<uint32_t>(latency);
+    request.status = static_cast<uint16_t>(status);
+    position_ = std::ftell(file_);
+    return true;
+}
+
+bool CaptureReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = std::fgetc(file_);
+        if (c == EOF) return false;
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+bool CaptureReader::readString(std::string& value) {
+    uint64_t size = 0;
+    if (!readVarint(size)) return false;
+    value.resize(size);
+    return size == 0 || std::fread(&value[0], 1, size, file_) == size;
+}
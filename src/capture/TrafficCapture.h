@@ -0,0 +1,105 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CapturedRequest {
+    uint64_t offsetUs = 0;
+    uint32_t latencyUs = 0;
+    uint16_t status = 0;
+    std::string method;
+    std::string path;
+    std::string query;
+    std::string body;
+    // Headers that change what the request does; empty when absent.
+    std::string idempotencyKey;
+    std::string minLsn;
+};
+
+struct TrafficCaptureStats {
+    uint64_t recorded = 0;
+    uint64_t dropped = 0;
+    uint64_t bytes = 0;
+};
+
+// Append-only binary log of served requests. The file starts with an 8-byte
+// magic, the capture start time and the reviewer RNG seed, followed by
+// records of varint-encoded integers and length-prefixed strings.
+//
+// A restart appends to an existing capture: a record cut short by a crash is
+// cut off, and offsets continue from the last record, so the downtime does not
+// show up as a pause on replay.
+//
+// Request threads only move the record into a bounded queue; a background
+// thread encodes and writes batches. When the writer falls behind, new
+// records are dropped and counted instead of slowing requests down.
+class TrafficCapture {
+public:
+    TrafficCapture(const std::string& path, size_t queueCapacity, uint64_t rngSeed);
+    ~TrafficCapture();
+
+    bool start();
+    // Writes what is still queued and closes the file.
+    void stop();
+
+    // Microseconds since start(), for CapturedRequest::offsetUs.
+    uint64_t elapsedUs() const;
+    void record(CapturedRequest&& request);
+
+    TrafficCaptureStats stats() const;
+
+private:
+    std::string path_;
+    size_t queueCapacity_;
+    uint64_t rngSeed_;
+    std::FILE* file_ = nullptr;
+    uint64_t startedUs_ = 0;
+
+    std::vector<CapturedRequest> queue_;
+    uint64_t recorded_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t bytes_ = 0;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::thread writer_;
+    bool stopping_ = false;
+
+    bool resume();
+    void run();
+};
+
+// Reads a capture written by TrafficCapture.
+class CaptureReader {
+public:
+    ~CaptureReader();
+
+    // Reads the header; captures of the previous format (no headers in the
+    // records) are read too.
+    bool open(const std::string& path);
+    // False at the end of the file or on a truncated record.
+    bool next(CapturedRequest& request);
+
+    uint64_t startedUs() const { return startedUs_; }
+    uint64_t rngSeed() const { return rngSeed_; }
+    // Whether records are in the format TrafficCapture writes now.
+    bool current() const { return version_ == CURRENT_VERSION; }
+    // End of the last record next() returned.
+    long position() const { return position_; }
+
+private:
+    static constexpr int CURRENT_VERSION = 2;
+
+    std::FILE* file_ = nullptr;
+    uint64_t startedUs_ = 0;
+    uint64_t rngSeed_ = 0;
+    int version_ = 0;
+    long position_ = 0;
+
+    bool readVarint(uint64_t& value);
+    bool readString(std::string& value);
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ConfigValue {
+    std::string value;
+    std::string source;
+};
+
+// Runtime settings. Each key is looked up in the environment first, then in
+// the optional config file (KEY=VALUE lines, '#' comments), then falls back to
+// the caller's default. Every resolved key is remembered for /config.
+class Config {
+public:
+    bool loadFile(const std::string& path);
+
+    std::string getString(const std::string& name, const std::string& defaultValue = "");
+    int getInt(const std::string& name, int defaultValue);
+    bool getBool(const std::string& name, bool defaultValue);
+    std::vector<std::string> getList(const std::string& name, char separator = ',');
+
+    // Resolved values with credentials in connection URLs masked.
+    std::map<std::string, ConfigValue> effective() const;
+    std::string filePath() const { return filePath_; }
+
+    static std::string maskCredentials(const std::string& value);
+
+private:
+    std::string filePath_;
+    std::map<std::string, std::string> fileValues_;
+    std::map<std::string, ConfigValue> resolved_;
+    mutable std::mutex mutex_;
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct BatchLoaderStats {
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+    uint64_t keys = 0;
+    uint64_t coalesced = 0;
+};
+
+// Dataloader-style point lookups. Callers that arrive while an earlier batch
+// is running gather into one pending batch, identical keys are fetched once,
+// and the first caller of the batch runs it when the running one finishes.
+// Callers never join a batch that already started, so a result is never older
+// than the call that asked for it.
+template <typename Key, typename Value>
+class BatchLoader {
+public:
+    using Results = std::unordered_map<Key, Value>;
+    // minPosition is the highest read position (replica LSN) any caller needs.
+    using Fetch = std::function<Results(const std::vector<Key>&, uint64_t minPosition)>;
+
+    BatchLoader(Fetch fetch, size_t maxBatch, std::chrono::microseconds maxWait)
+        : fetch_(std::move(fetch)), maxBatch_(maxBatch), maxWait_(maxWait) {}
+
+    std::optional<Value> load(const Key& key, uint64_t minPosition = 0) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stats_.requests++;
+
+        bool leader = false;
+        if (!pending_ || pending_->keys.size() >= maxBatch_) {
+            pending_ = std::make_shared<Batch>();
+            leader = true;
+        }
+        std::shared_ptr<Batch> batch = pending_;
+        if (batch->requested.insert(key).second) {
+            batch->keys.push_back(key);
+            if (batch->keys.size() >= maxBatch_) changed_.notify_all();
+        } else {
+            stats_.coalesced++;
+        }
+        batch->minPosition = std::max(batch->minPosition, minPosition);
+
+        if (leader) {
+            changed_.wait_for(lock, maxWait_, [&] {
+                return running_ == 0 || batch->keys.size() >= maxBatch_;
+            });
+            if (pending_ == batch) pending_.reset();
+            running_++;
+            lock.unlock();
+
+            try {
+                batch->results = fetch_(batch->keys, batch->minPosition);
+            } catch (...) {
+                batch->error = std::current_exception();
+            }
+
+            lock.lock();
+            running_--;
+            stats_.batches++;
+            stats_.keys += batch->keys.size();
+            batch->done = true;
+            changed_.notify_all();
+        } else {
+            changed_.wait(lock, [&] { return batch->done; });
+        }
+
+        if (batch->error) std::rethrow_exception(batch->error);
+        auto it = batch->results.find(key);
+        if (it == batch->results.end()) return std::nullopt;
+        return it->second;
+    }
+
+    BatchLoaderStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct Batch {
+        std::vector<Key> keys;
+        std::unordered_set<Key> requested;
+        uint64_t minPosition = 0;
+        Results results;
+        std::exception_ptr error;
+        bool done = false;
+    };
+
+    Fetch fetch_;
+    size_t maxBatch_;
+    std::chrono::microseconds maxWait_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::shared_ptr<Batch> pending_;
+    int running_ = 0;
+    BatchLoaderStats stats_;
+};
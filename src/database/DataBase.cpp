@@ -1,64 +1,453 @@
 #include "Database.h"
+#include "../services/ReviewEventBus.h"
+#include "../cache/ReviewCache.h"
+#include "../cache/AvailabilityIndex.h"
+#include "RowDecoder.h"
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include <map>
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
 
+namespace {
+
+std::map<int, std::vector<OutboxEntry>> groupByShard(const std::vector<OutboxEntry>& entries) {
+    std::map<int, std::vector<OutboxEntry>> groups;
+    for (const auto& entry : entries) {
+        groups[entry.shard].push_back(entry);
+    }
+    return groups;
+}
+
+// Runs one statement of a team move or a directory update. The first cell of a row result goes to
+// value; a failure leaves the server's message in error.
+bool runStep(PGconn* conn, const char* sql, const std::vector<std::string>& params,
+             std::string& error, std::string* value = nullptr) {
+    std::vector<const char*> values;
+    for (const auto& param : params) {
+        values.push_back(param.c_str());
+    }
+    PGresult* res = PQexecParams(conn, sql, static_cast<int>(values.size()), nullptr, values.data(),
+                                 nullptr, nullptr, 0);
+    ExecStatusType status = PQresultStatus(res);
+    bool success = status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK;
+    if (!success) {
+        error = PQresultErrorMessage(res);
+    } else if (value && PQntuples(res) > 0) {
+        *value = PQgetvalue(res, 0, 0);
+    }
+    PQclear(res);
+    return success;
+}
+
+// Deletes a team with its PRs; reviewer rows and availability windows go
+// with them through ON DELETE CASCADE.
+bool dropTeamRows(PGconn* conn, const std::string& teamName, std::string& error) {
+    return runStep(conn,
+               "DELETE FROM pull_request_ids WHERE id IN (SELECT p.id FROM pull_requests p WHERE p.author_id IN ("
+               "  SELECT u.id FROM users u JOIN teams t ON t.id = u.team_id WHERE t.name = $1))",
+               { teamName }, error) &&
+           runStep(conn,
+               "DELETE FROM users WHERE team_id = (SELECT id FROM teams WHERE name = $1)",
+               { teamName }, error) &&
+           runStep(conn, "DELETE FROM teams WHERE name = $1", { teamName }, error);
+}
+
+}
+
 Database& Database::getInstance() {
     static Database instance;
     return instance;
 }
 
-bool Database::connect(const std::string& connectionString) {
+bool Database::connect(const std::string& connectionString, int poolSize) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    connectionString_ = connectionString;
+    shardPoolSize_ = std::max(1, poolSize);
     connection_ = PQconnectdb(connectionString.c_str());
-    if (PQstatus(connection_) != CONNECTION_OK) {
+    if (PQstatus(connection_) != CONNECTION_OK || !RowDecoder::useUtc(connection_)) {
         std::cerr << "Database connection failed: " << PQerrorMessage(connection_) << std::endl;
         return false;
     }
+    if (!shards_.addShard(connectionString, shardPoolSize_)) {
+        return false;
+    }
     std::cout << "Connected to PostgreSQL database" << std::endl;
     return true;
 }
 
+bool Database::connectShard(const std::string& connectionString) {
+    return shards_.addShard(connectionString, shardPoolSize_);
+}
+
 void Database::disconnect() {
+    replicas_.stop();
+    shards_.closeAll();
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (connection_) {
         PQfinish(connection_);
         connection_ = nullptr;
     }
 }
 
+void Database::setEventBus(ReviewEventBus* eventBus) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    eventBus_ = eventBus;
+}
+
+void Database::setCache(ReviewCache* cache) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    cache_ = cache;
+}
+
+void Database::setOutboxTargets(std::vector<std::string> targets) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    outboxTargets_ = std::move(targets);
+}
+
+void Database::setAvailability(AvailabilityIndex* availability) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    availability_ = availability;
+}
+
+void Database::publishEvents(const std::vector<ReviewEvent>& events) {
+    if (cache_) {
+        for (const auto& event : events) {
+            cache_->invalidateReviews(event.user_id);
+        }
+    }
+    if (eventBus_) {
+        for (const auto& event : events) {
+            eventBus_->publish(event);
+        }
+    }
+}
+
+bool Database::writeOutbox(const std::vector<ReviewEvent>& events) {
+    if (outboxTargets_.empty() || events.empty()) return true;
+    std::vector<std::string> targets;
+    std::vector<std::string> types;
+    std::vector<std::string> userIds;
+    std::vector<std::string> prIds;
+    for (const auto& event : events) {
+        for (const auto& target : outboxTargets_) {
+            targets.push_back(target);
+            types.push_back(event.getTypeString());
+            userIds.push_back(event.user_id);
+            prIds.push_back(event.pr_id);
+        }
+    }
+    std::string targetArray = textArray(targets);
+    std::string typeArray = textArray(types);
+    std::string userArray = textArray(userIds);
+    std::string prArray = textArray(prIds);
+    const char* params[4] = { targetArray.c_str(), typeArray.c_str(), userArray.c_str(), prArray.c_str() };
+    // Ordinality keeps outbox ids in event order.
+    PGresult* res = PQexecParams(conn(),
+        "INSERT INTO review_outbox (target, event_type, user_id, pr_id) "
+        "SELECT target, event_type, user_id, pr_id "
+        "FROM unnest($1::varchar[], $2::varchar[], $3::varchar[], $4::varchar[]) "
+        "WITH ORDINALITY AS e(target, event_type, user_id, pr_id, n) ORDER BY n",
+        4, nullptr, params, nullptr, nullptr, 0);
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    return success;
+}
+
+// Publishes the events on review_events from the current transaction (see
+// migration 009); every instance's listener feeds them to its analytics.
+bool Database::notifyEvents(const std::vector<ReviewEvent>& events) {
+    if (events.empty()) return true;
+    std::vector<std::string> types;
+    std::vector<std::string> userIds;
+    std::vector<std::string> prIds;
+    for (const auto& event : events) {
+        types.push_back(event.getTypeString());
+        userIds.push_back(event.user_id);
+        prIds.push_back(event.pr_id);
+    }
+    std::string typeArray = textArray(types);
+    std::string userArray = textArray(userIds);
+    std::string prArray = textArray(prIds);
+    const char* params[3] = { typeArray.c_str(), userArray.c_str(), prArray.c_str() };
+    PGresult* res = PQexecParams(conn(),
+        "SELECT notify_review_event(event_type, user_id, pr_id) "
+        "FROM unnest($1::varchar[], $2::varchar[], $3::varchar[]) "
+        "WITH ORDINALITY AS e(event_type, user_id, pr_id, n) ORDER BY n",
+        3, nullptr, params, nullptr, nullptr, 0);
+    bool success = PQresultStatus(res) == PGRES_TUPLES_OK;
+    PQclear(res);
+    return success;
+}
+
+bool Database::endTransaction(bool commit) {
+    PGresult* res = PQexec(conn(), commit ? "COMMIT" : "ROLLBACK");
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    return commit && success;
+}
+
 bool Database::isConnected() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     return connection_ && PQstatus(connection_) == CONNECTION_OK;
 }
 
+thread_local uint64_t Database::sessionLsn_ = 0;
+thread_local bool Database::sessionWrote_ = false;
+thread_local int Database::boundShard_ = -1;
+thread_local PGconn* Database::boundConnection_ = nullptr;
+
+Database::ShardScope::ShardScope(Database& db, int shard)
+    : previousShard_(boundShard_), previousConnection_(boundConnection_) {
+    if (boundShard_ == shard) return;
+    lease_ = db.shards_.acquire(shard);
+    boundShard_ = shard;
+    boundConnection_ = lease_.get();
+}
+
+Database::ShardScope::~ShardScope() {
+    release();
+}
+
+void Database::ShardScope::release() {
+    boundShard_ = previousShard_;
+    boundConnection_ = previousConnection_;
+    lease_ = ShardRouter::Lease();
+}
+
+// Teams missing from the directory do not exist yet; migration 008 recorded
+// every team created before sharding on shard 0.
+int Database::shardForTeam(const std::string& teamName, bool* known) {
+    if (known) *known = false;
+    if (shards_.shardCount() <= 1) return 0;
+    int shard = shards_.cachedTeam(teamName);
+    if (shard == ShardRouter::NOT_FOUND) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        const char* params[1] = { teamName.c_str() };
+        PGresult* res = PQexecParams(connection_,
+            "SELECT shard_id FROM team_shards WHERE team_name = $1",
+            1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
+        bool found = PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0;
+        shard = found ? static_cast<int>(RowDecoder(res, 0).integer(0)) : 0;
+        PQclear(res);
+        if (!found) return 0;
+        if (shard >= shards_.shardCount()) {
+            std::cerr << "Team " << teamName << " is on shard " << shard
+                      << ", which is not configured in SHARD_URLS" << std::endl;
+            return 0;
+        }
+        shards_.rememberTeam(teamName, shard);
+    }
+    if (known) *known = true;
+    return shard;
+}
+
+int Database::shardForUser(const std::string& userId) {
+    if (shards_.shardCount() <= 1) return 0;
+    int shard = shards_.cachedUser(userId);
+    if (shard == ShardRouter::NOT_FOUND) {
+        shard = probeShards("SELECT 1 FROM users WHERE id = $1", userId);
+        if (shard != ShardRouter::NOT_FOUND) {
+            shards_.rememberUser(userId, shard);
+        }
+    }
+    return shard;
+}
+
+// The pull_request_shards directory is authoritative; a miss is probed so PRs
+// created on other shards before migration 010 are found, and recorded.
+int Database::shardForPullRequest(const std::string& prId) {
+    if (shards_.shardCount() <= 1) return 0;
+    int shard = shards_.cachedPullRequest(prId);
+    if (shard != ShardRouter::NOT_FOUND) return shard;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        const char* params[1] = { prId.c_str() };
+        PGresult* res = PQexecParams(connection_,
+            "SELECT shard_id FROM pull_request_shards WHERE pull_request_id = $1",
+            1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
+        if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
+            shard = static_cast<int>(RowDecoder(res, 0).integer(0));
+        }
+        PQclear(res);
+    }
+    if (shard == ShardRouter::NOT_FOUND) {
+        shard = probeShards("SELECT 1 FROM pull_requests WHERE id = $1", prId);
+        if (shard == ShardRouter::NOT_FOUND) return shard;
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        std::string ignored;
+        runStep(connection_,
+            "INSERT INTO pull_request_shards (pull_request_id, shard_id) VALUES ($1, $2::int) "
+            "ON CONFLICT (pull_request_id) DO NOTHING",
+            { prId, std::to_string(shard) }, ignored);
+    }
+    if (shard >= shards_.shardCount()) {
+        std::cerr << "PR " << prId << " is on shard " << shard
+                  << ", which is not configured in SHARD_URLS" << std::endl;
+        return ShardRouter::NOT_FOUND;
+    }
+    shards_.rememberPullRequest(prId, shard);
+    return shard;
+}
+
+int Database::probeShards(const char* query, const std::string& key) {
+    shards_.noteProbe();
+    const char* params[1] = { key.c_str() };
+    for (int shard = 0; shard < shards_.shardCount(); shard++) {
+        ShardScope scope(*this, shard);
+        PGresult* res = PQexecParams(conn(), query, 1, nullptr, params, nullptr, nullptr, 0);
+        bool found = PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0;
+        PQclear(res);
+        if (found) return shard;
+    }
+    return ShardRouter::NOT_FOUND;
+}
+
+int Database::teamShard(const std::string& teamName) {
+    if (shards_.shardCount() <= 1) {
+        return teamExists(teamName) ? 0 : ShardRouter::NOT_FOUND;
+    }
+    bool known = false;
+    int shard = shardForTeam(teamName, &known);
+    return known ? shard : ShardRouter::NOT_FOUND;
+}
+
+void Database::forgetTeamShard(const std::string& teamName) {
+    shards_.forgetTeam(teamName);
+}
+
+bool Database::connectReplica(const std::string& connectionString) {
+    return replicas_.addReplica(connectionString);
+}
+
+void Database::startReplicaMonitor(std::chrono::milliseconds interval, std::chrono::milliseconds maxLag,
+                                   std::chrono::milliseconds maxWait) {
+    replicaWait_ = maxWait;
+    replicas_.startMonitor([this]() { return currentWalLsn(); }, interval, maxLag);
+}
+
+std::vector<ReplicaStatus> Database::replicaStatus() const {
+    return replicas_.status();
+}
+
+void Database::beginSession(const std::string& minLsn) {
+    sessionLsn_ = ReplicaRouter::parseLsn(minLsn.c_str());
+    sessionWrote_ = false;
+}
+
+std::string Database::sessionWriteLsn() {
+    return sessionWrote_ ? ReplicaRouter::formatLsn(sessionLsn_) : "";
+}
+
+uint64_t Database::currentWalLsn() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    PGresult* res = PQexecParams(connection_, "SELECT pg_current_wal_lsn()",
+                                 0, nullptr, nullptr, nullptr, nullptr, RowDecoder::BINARY);
+    uint64_t lsn = 0;
+    if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
+        lsn = RowDecoder(res, 0).lsn(0);
+    }
+    PQclear(res);
+    return lsn;
+}
+
+void Database::recordWrite() {
+    // Only shard 0 has replicas, and LSNs of other shards are not comparable.
+    if (!replicas_.hasReplicas() || boundShard_ > 0) return;
+    uint64_t lsn = currentWalLsn();
+    sessionLsn_ = std::max(sessionLsn_, lsn);
+    sessionWrote_ = true;
+    noteExternalWrite(lsn);
+}
+
+void Database::noteExternalWrite(uint64_t lsn) {
+    uint64_t previous = lastWriteLsn_;
+    while (previous < lsn && !lastWriteLsn_.compare_exchange_weak(previous, lsn)) {}
+}
+
+uint64_t Database::readLsn() const {
+    // Cache fills must not observe anything older than this node's own writes,
+    // otherwise an invalidated entry could be refilled from a lagging replica.
+    return cache_ ? std::max(sessionLsn_, lastWriteLsn_.load()) : sessionLsn_;
+}
+
+template <typename Query>
+auto Database::withReadConnection(uint64_t minLsn, Query&& query, int shard) -> decltype(query(nullptr)) {
+    if (shard == 0 && replicas_.hasReplicas()) {
+        auto lease = replicas_.acquire(minLsn, replicaWait_);
+        if (lease) {
+            auto result = query(lease.get());
+            if (PQstatus(lease.get()) == CONNECTION_OK) {
+                return result;
+            }
+        }
+    }
+    ShardScope scope(*this, shard);
+    return query(conn());
+}
+
 int Database::getTeamId(const std::string& teamName) {
     const char* params[1] = {teamName.c_str()};
-    PGresult* res = PQexecParams(connection_,
-        "SELECT id FROM teams WHERE name = $1", 1, nullptr, params, nullptr, nullptr, 0);
+    PGresult* res = PQexecParams(conn(),
+        "SELECT id FROM teams WHERE name = $1", 1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return -1;
     }
     
-    int teamId = std::stoi(PQgetvalue(res, 0, 0));
+    int teamId = static_cast<int>(RowDecoder(res, 0).integer(0));
     PQclear(res);
     return teamId;
 }
 
 bool Database::createTeam(const Team& team) {
-    const char* params[1] = {team.name.c_str()};
-    PGresult* res = PQexecParams(connection_,
-        "INSERT INTO teams (name) VALUES ($1) ON CONFLICT (name) DO NOTHING",
-        1, nullptr, params, nullptr, nullptr, 0);
+    bool known = false;
+    int shard = shardForTeam(team.name, &known);
+    if (!known) {
+        // The directory row wins if another node created the team meanwhile.
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        std::string placement = std::to_string(shards_.placeTeam(team.name));
+        const char* placeParams[2] = { team.name.c_str(), placement.c_str() };
+        PGresult* placeRes = PQexecParams(connection_,
+            "INSERT INTO team_shards (team_name, shard_id) VALUES ($1, $2::int) "
+            "ON CONFLICT (team_name) DO UPDATE SET team_name = EXCLUDED.team_name "
+            "RETURNING shard_id",
+            2, nullptr, placeParams, nullptr, nullptr, 0);
+        bool placed = PQresultStatus(placeRes) == PGRES_TUPLES_OK && PQntuples(placeRes) > 0;
+        shard = placed ? std::atoi(PQgetvalue(placeRes, 0, 0)) : -1;
+        PQclear(placeRes);
+        if (shard < 0 || shard >= shards_.shardCount()) return false;
+        shards_.rememberTeam(team.name, shard);
+    }
+    // Members are written after the scope ends: createOrUpdateUser may probe
+    // other shards, and a thread never holds two shard connections at once.
+    bool success = false;
+    int teamId = -1;
+    {
+        ShardScope scope(*this, shard);
+        const char* params[1] = {team.name.c_str()};
+        PGresult* res = PQexecParams(conn(),
+            "INSERT INTO teams (name) VALUES ($1) ON CONFLICT (name) DO NOTHING",
+            1, nullptr, params, nullptr, nullptr, 0);
+        
+        success = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+        if (success) {
+            teamId = getTeamId(team.name);
+            recordWrite();
+        }
+    }
     
-    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
-    PQclear(res);
+    if (cache_) {
+        cache_->invalidateTeam(team.name);
+    }
     
-    if (success) {
-        int teamId = getTeamId(team.name);
-        if (teamId != -1) {
-            for (const auto& member : team.members) {
-                createOrUpdateUser(member);
-            }
+    if (teamId != -1) {
+        for (const auto& member : team.members) {
+            createOrUpdateUser(member);
         }
     }
     
@@ -66,25 +455,43 @@ bool Database::createTeam(const Team& team) {
 }
 
 std::unique_ptr<Team> Database::getTeam(const std::string& teamName) {
+    uint64_t cacheVersion = 0;
+    if (cache_) {
+        cacheVersion = cache_->version();
+        if (auto cached = cache_->getTeam(teamName)) {
+            return std::make_unique<Team>(std::move(*cached));
+        }
+    }
+    
+    auto team = withReadConnection(readLsn(), [&](PGconn* conn) { return queryTeam(conn, teamName); },
+                                   shardForTeam(teamName));
+    if (team && cache_) {
+        cache_->putTeam(*team, cacheVersion);
+    }
+    return team;
+}
+
+std::unique_ptr<Team> Database::queryTeam(PGconn* conn, const std::string& teamName) {
     const char* params[1] = {teamName.c_str()};
-    PGresult* res = PQexecParams(connection_,
+    PGresult* res = PQexecParams(conn,
         "SELECT t.name, u.id, u.username, u.is_active "
         "FROM teams t LEFT JOIN users u ON t.id = u.team_id "
-        "WHERE t.name = $1", 1, nullptr, params, nullptr, nullptr, 0);
+        "WHERE t.name = $1", 1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return nullptr;
     }
     
-    auto team = std::make_unique<Team>(PQgetvalue(res, 0, 0));
+    auto team = std::make_unique<Team>(RowDecoder(res, 0).text(0));
     for (int i = 0; i < PQntuples(res); i++) {
-        if (PQgetvalue(res, i, 1) != nullptr) {
+        RowDecoder row(res, i);
+        if (!row.isNull(1)) {
             team->members.emplace_back(
-                PQgetvalue(res, i, 1),
-                PQgetvalue(res, i, 2),
+                row.text(1),
+                row.text(2),
                 teamName,
-                PQgetvalue(res, i, 3)[0] == 't'
+                row.boolean(3)
             );
         }
     }
@@ -94,21 +501,33 @@ std::unique_ptr<Team> Database::getTeam(const std::string& teamName) {
 }
 
 bool Database::teamExists(const std::string& teamName) {
+    ShardScope scope(*this, shardForTeam(teamName));
     return getTeamId(teamName) != -1;
 }
 
 bool Database::createOrUpdateUser(const User& user) {
+    int shard = shardForTeam(user.team_name);
+    // PRs and reviews stay on the user's shard, so a user cannot follow a
+    // team change onto another one.
+    int current = shardForUser(user.id);
+    if (current != ShardRouter::NOT_FOUND && current != shard) {
+        std::cerr << "User " << user.id << " is on shard " << current << ", cannot join team "
+                  << user.team_name << " on shard " << shard << std::endl;
+        return false;
+    }
+    ShardScope scope(*this, shard);
     int teamId = getTeamId(user.team_name);
     if (teamId == -1) return false;
     
+    std::string teamIdStr = std::to_string(teamId);
     const char* params[4] = {
         user.id.c_str(),
         user.username.c_str(),
-        std::to_string(teamId).c_str(),
+        teamIdStr.c_str(),
         user.is_active ? "true" : "false"
     };
     
-    PGresult* res = PQexecParams(connection_,
+    PGresult* res = PQexecParams(conn(),
         "INSERT INTO users (id, username, team_id, is_active) "
         "VALUES ($1, $2, $3, $4) "
         "ON CONFLICT (id) DO UPDATE SET "
@@ -117,69 +536,152 @@ bool Database::createOrUpdateUser(const User& user) {
     
     bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
     PQclear(res);
+    if (success) {
+        recordWrite();
+        shards_.rememberUser(user.id, shard);
+        if (availability_) {
+            availability_->moveUser(user.id, user.team_name);
+        }
+    }
+    if (cache_) {
+        cache_->invalidateUser(user.id);
+        cache_->invalidateTeam(user.team_name);
+    }
     return success;
 }
 
 bool Database::setUserActive(const std::string& userId, bool isActive) {
+    int shard = shardForUser(userId);
+    if (shard == ShardRouter::NOT_FOUND) return false;
+    ShardScope scope(*this, shard);
     const char* params[2] = {
         isActive ? "true" : "false",
         userId.c_str()
     };
     
-    PGresult* res = PQexecParams(connection_,
+    PGresult* res = PQexecParams(conn(),
         "UPDATE users SET is_active = $1 WHERE id = $2",
         2, nullptr, params, nullptr, nullptr, 0);
     
     bool success = PQresultStatus(res) == PGRES_COMMAND_OK && PQcmdTuples(res)[0] != '0';
     PQclear(res);
+    if (success) {
+        recordWrite();
+    }
+    if (cache_) {
+        cache_->invalidateUser(userId);
+    }
     return success;
 }
 
 std::unique_ptr<User> Database::getUser(const std::string& userId) {
+    int shard = shardForUser(userId);
+    if (shard == ShardRouter::NOT_FOUND) return nullptr;
+    return withReadConnection(readLsn(), [&](PGconn* conn) { return queryUser(conn, userId); }, shard);
+}
+
+std::unique_ptr<User> Database::queryUser(PGconn* conn, const std::string& userId) {
     const char* params[1] = {userId.c_str()};
-    PGresult* res = PQexecParams(connection_,
+    PGresult* res = PQexecParams(conn,
         "SELECT u.id, u.username, t.name, u.is_active "
         "FROM users u JOIN teams t ON u.team_id = t.id "
-        "WHERE u.id = $1", 1, nullptr, params, nullptr, nullptr, 0);
+        "WHERE u.id = $1", 1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return nullptr;
     }
     
+    RowDecoder row(res, 0);
     auto user = std::make_unique<User>(
-        PQgetvalue(res, 0, 0),
-        PQgetvalue(res, 0, 1),
-        PQgetvalue(res, 0, 2),
-        PQgetvalue(res, 0, 3)[0] == 't'
+        row.text(0),
+        row.text(1),
+        row.text(2),
+        row.boolean(3)
     );
     
     PQclear(res);
     return user;
 }
 
+std::unordered_map<std::string, User> Database::getUsers(const std::vector<std::string>& userIds,
+                                                         uint64_t minLsn) {
+    std::string ids = textArray(userIds);
+    const char* params[1] = {ids.c_str()};
+    std::unordered_map<std::string, User> users;
+    // Every shard gets the whole batch; each user is found on exactly one.
+    for (int shard = 0; shard < shards_.shardCount(); shard++) {
+        withReadConnection(std::max(minLsn, readLsn()), [&](PGconn* conn) {
+            PGresult* res = PQexecParams(conn,
+                "SELECT u.id, u.username, t.name, u.is_active "
+                "FROM users u JOIN teams t ON u.team_id = t.id "
+                "WHERE u.id = ANY($1::varchar[])", 1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
+            if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+                for (int i = 0; i < PQntuples(res); i++) {
+                    RowDecoder row(res, i);
+                    std::string id = row.text(0);
+                    shards_.rememberUser(id, shard);
+                    users.emplace(id, User(id, row.text(1), row.text(2), row.boolean(3)));
+                }
+            }
+            PQclear(res);
+            return true;
+        }, shard);
+    }
+    return users;
+}
+
 std::vector<User> Database::getActiveTeamMembers(const std::string& teamName, const std::string& excludeUserId) {
+    std::vector<User> members = queryActiveTeamMembers(teamName, excludeUserId);
+    if (availability_ && !members.empty()) {
+        auto away = availability_->unavailableAt(teamName, std::chrono::system_clock::now());
+        if (!away.empty()) {
+            members.erase(std::remove_if(members.begin(), members.end(), [&away](const User& member) {
+                return away.count(member.id) > 0;
+            }), members.end());
+        }
+    }
+    return members;
+}
+
+std::vector<User> Database::queryActiveTeamMembers(const std::string& teamName, const std::string& excludeUserId) {
+    if (cache_) {
+        std::vector<User> members;
+        auto team = getTeam(teamName);
+        if (team) {
+            for (auto& member : team->members) {
+                if (member.is_active && member.id != excludeUserId) {
+                    members.push_back(std::move(member));
+                }
+            }
+        }
+        return members;
+    }
+    
+    ShardScope scope(*this, shardForTeam(teamName));
     int teamId = getTeamId(teamName);
     if (teamId == -1) return {};
     
+    std::string teamIdStr = std::to_string(teamId);
     const char* params[2] = {
-        std::to_string(teamId).c_str(),
+        teamIdStr.c_str(),
         excludeUserId.c_str()
     };
     
-    PGresult* res = PQexecParams(connection_,
+    PGresult* res = PQexecParams(conn(),
         "SELECT id, username, is_active FROM users "
         "WHERE team_id = $1 AND is_active = true AND id != $2",
-        2, nullptr, params, nullptr, nullptr, 0);
+        2, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
     
     std::vector<User> members;
     if (PQresultStatus(res) == PGRES_TUPLES_OK) {
         for (int i = 0; i < PQntuples(res); i++) {
+            RowDecoder row(res, i);
             members.emplace_back(
-                PQgetvalue(res, i, 0),
-                PQgetvalue(res, i, 1),
+                row.text(0),
+                row.text(1),
                 teamName,
-                PQgetvalue(res, i, 2)[0] == 't'
+                row.boolean(2)
             );
         }
     }
@@ -189,65 +691,164 @@ std::vector<User> Database::getActiveTeamMembers(const std::string& teamName, co
 }
 
 bool Database::createPullRequest(const PullRequest& pr) {
+    int shard = shardForUser(pr.author_id);
+    if (shard == ShardRouter::NOT_FOUND) return false;
+    // The id is claimed in the pull_request_shards directory on shard 0. On
+    // another shard the claim is a second transaction that commits right
+    // after the PR's, so a concurrent create of the same id waits on it and
+    // then fails. Shard 0 is leased first, in the order moveTeam uses.
+    ShardRouter::Lease directory;
+    if (shard != 0) {
+        directory = shards_.acquire(0);
+    }
+    ShardScope scope(*this, shard);
+    PGconn* directoryConn = shard == 0 ? conn() : directory.get();
     const char* params[3] = {
         pr.id.c_str(),
         pr.name.c_str(),
         pr.author_id.c_str()
     };
     
-    PGresult* res = PQexecParams(connection_,
-        "INSERT INTO pull_requests (id, name, author_id) VALUES ($1, $2, $3)",
-        3, nullptr, params, nullptr, nullptr, 0);
+    std::string error;
+    if (shard != 0 && !runStep(directoryConn, "BEGIN", {}, error)) {
+        return false;
+    }
+    PGresult* beginRes = PQexec(conn(), "BEGIN");
+    PQclear(beginRes);
     
-    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
-    PQclear(res);
+    bool success = runStep(directoryConn,
+        "INSERT INTO pull_request_shards (pull_request_id, shard_id) VALUES ($1, $2::int)",
+        { pr.id, std::to_string(shard) }, error);
+    
+    // The id registry rejects an id that exists in either partition.
+    if (success) {
+        PGresult* res = PQexecParams(conn(),
+            "WITH registered AS (INSERT INTO pull_request_ids (id) VALUES ($1) RETURNING id) "
+            "INSERT INTO pull_requests (id, name, author_id) SELECT id, $2, $3 FROM registered",
+            3, nullptr, params, nullptr, nullptr, 0);
+        success = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+    }
     
+    std::vector<ReviewEvent> events;
     if (success && !pr.assigned_reviewers.empty()) {
         for (const auto& reviewer : pr.assigned_reviewers) {
             const char* reviewerParams[2] = {pr.id.c_str(), reviewer.c_str()};
-            PGresult* revRes = PQexecParams(connection_,
+            PGresult* revRes = PQexecParams(conn(),
                 "INSERT INTO pr_reviewers (pr_id, reviewer_id) VALUES ($1, $2)",
                 2, nullptr, reviewerParams, nullptr, nullptr, 0);
+            success = PQresultStatus(revRes) == PGRES_COMMAND_OK;
             PQclear(revRes);
+            if (!success) break;
+            events.emplace_back(ReviewEventType::ASSIGNED, reviewer, pr.id);
         }
     }
     
-    return success;
+    success = success && writeOutbox(events) && notifyEvents(events);
+    bool committed = endTransaction(success);
+    if (shard != 0 && !runStep(directoryConn, committed ? "COMMIT" : "ROLLBACK", {}, error) && committed) {
+        // Without its claim the id is not unique across shards, so the PR is
+        // taken back out. Its reviewers were already notified of the
+        // assignment and now get UNASSIGNED.
+        std::cerr << "PR " << pr.id << " was created on shard " << shard
+                  << ", but claiming its id in the directory failed, removing it: " << error << std::endl;
+        std::vector<ReviewEvent> withdrawn;
+        for (const auto& event : events) {
+            withdrawn.emplace_back(ReviewEventType::UNASSIGNED, event.user_id, pr.id);
+        }
+        PGresult* undoRes = PQexec(conn(), "BEGIN");
+        PQclear(undoRes);
+        bool removed = runStep(conn(), "DELETE FROM pull_request_ids WHERE id = $1", { pr.id }, error) &&
+                       writeOutbox(withdrawn) && notifyEvents(withdrawn);
+        if (!endTransaction(removed)) {
+            std::cerr << "PR " << pr.id << " could not be removed from shard " << shard
+                      << " either: " << error << std::endl;
+        }
+        recordWrite();
+        if (cache_) {
+            cache_->noteWrite();
+        }
+        committed = false;
+    }
+    if (!committed) {
+        return false;
+    }
+    
+    recordWrite();
+    shards_.rememberPullRequest(pr.id, shard);
+    scope.release();
+    if (cache_ && events.empty()) {
+        cache_->noteWrite();
+    }
+    publishEvents(events);
+    return true;
 }
 
 bool Database::mergePullRequest(const std::string& prId) {
+    int shard = shardForPullRequest(prId);
+    if (shard == ShardRouter::NOT_FOUND) return false;
+    ShardScope scope(*this, shard);
     const char* params[1] = {prId.c_str()};
     
-    PGresult* res = PQexecParams(connection_,
-        "UPDATE pull_requests SET status = 'MERGED', merged_at = CURRENT_TIMESTAMP "
-        "WHERE id = $1 AND status != 'MERGED'",
+    PGresult* res = PQexecParams(conn(),
+        "WITH merged AS ("
+        "  UPDATE pull_requests SET status = 'MERGED', merged_at = CURRENT_TIMESTAMP "
+        "  WHERE id = $1 AND status != 'MERGED' RETURNING id"
+        ") SELECT prr.reviewer_id, "
+        "  CASE WHEN prr.reviewer_id IS NOT NULL THEN notify_review_event('MERGED', prr.reviewer_id, m.id) END "
+        "FROM merged m LEFT JOIN pr_reviewers prr ON prr.pr_id = m.id",
         1, nullptr, params, nullptr, nullptr, 0);
     
-    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    // A PR merged just now has at least one row; one without reviewers
+    // comes back with a NULL reviewer.
+    bool success = PQresultStatus(res) == PGRES_TUPLES_OK;
+    bool merged = success && PQntuples(res) > 0;
+    std::vector<ReviewEvent> events;
+    if (success) {
+        for (int i = 0; i < PQntuples(res); i++) {
+            if (!PQgetisnull(res, i, 0)) {
+                events.emplace_back(ReviewEventType::MERGED, PQgetvalue(res, i, 0), prId);
+            }
+        }
+    }
     PQclear(res);
+    if (merged) {
+        recordWrite();
+    }
+    scope.release();
+    if (cache_ && merged) {
+        cache_->noteWrite();
+    }
+    publishEvents(events);
     return success;
 }
 
 std::unique_ptr<PullRequest> Database::getPullRequest(const std::string& prId) {
+    int shard = shardForPullRequest(prId);
+    if (shard == ShardRouter::NOT_FOUND) return nullptr;
+    ShardScope scope(*this, shard);
     const char* params[1] = {prId.c_str()};
     
-    PGresult* prRes = PQexecParams(connection_,
+    PGresult* prRes = PQexecParams(conn(),
         "SELECT id, name, author_id, status, created_at, merged_at "
-        "FROM pull_requests WHERE id = $1", 1, nullptr, params, nullptr, nullptr, 0);
+        "FROM pull_requests WHERE id = $1", 1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
     
     if (PQresultStatus(prRes) != PGRES_TUPLES_OK || PQntuples(prRes) == 0) {
         PQclear(prRes);
         return nullptr;
     }
     
+    RowDecoder row(prRes, 0);
     auto pr = std::make_unique<PullRequest>(
-        PQgetvalue(prRes, 0, 0),
-        PQgetvalue(prRes, 0, 1),
-        PQgetvalue(prRes, 0, 2),
-        PullRequest::stringToStatus(PQgetvalue(prRes, 0, 3))
+        row.text(0),
+        row.text(1),
+        row.text(2),
+        PullRequest::stringToStatus(row.text(3))
     );
+    pr->created_at = row.timestamp(4);
+    pr->merged_at = row.timestamp(5);
     
-    PGresult* revRes = PQexecParams(connection_,
+    PGresult* revRes = PQexecParams(conn(),
         "SELECT reviewer_id FROM pr_reviewers WHERE pr_id = $1",
         1, nullptr, params, nullptr, nullptr, 0);
     
@@ -263,31 +864,147 @@ std::unique_ptr<PullRequest> Database::getPullRequest(const std::string& prId) {
 }
 
 bool Database::updatePRReviewers(const std::string& prId, const std::vector<std::string>& reviewers) {
+    int shard = shardForPullRequest(prId);
+    if (shard == ShardRouter::NOT_FOUND) return false;
+    ShardScope scope(*this, shard);
+    PGresult* beginRes = PQexec(conn(), "BEGIN");
+    PQclear(beginRes);
+    
     const char* deleteParams[1] = {prId.c_str()};
-    PGresult* deleteRes = PQexecParams(connection_,
-        "DELETE FROM pr_reviewers WHERE pr_id = $1",
+    PGresult* deleteRes = PQexecParams(conn(),
+        "DELETE FROM pr_reviewers WHERE pr_id = $1 RETURNING reviewer_id",
         1, nullptr, deleteParams, nullptr, nullptr, 0);
+    
+    bool success = PQresultStatus(deleteRes) == PGRES_TUPLES_OK;
+    std::vector<std::string> previous;
+    if (success) {
+        for (int i = 0; i < PQntuples(deleteRes); i++) {
+            previous.push_back(PQgetvalue(deleteRes, i, 0));
+        }
+    }
     PQclear(deleteRes);
     
     for (const auto& reviewer : reviewers) {
+        if (!success) break;
         const char* insertParams[2] = {prId.c_str(), reviewer.c_str()};
-        PGresult* insertRes = PQexecParams(connection_,
+        PGresult* insertRes = PQexecParams(conn(),
             "INSERT INTO pr_reviewers (pr_id, reviewer_id) VALUES ($1, $2)",
             2, nullptr, insertParams, nullptr, nullptr, 0);
+        success = PQresultStatus(insertRes) == PGRES_COMMAND_OK;
         PQclear(insertRes);
     }
     
+    std::vector<ReviewEvent> events;
+    for (const auto& reviewer : previous) {
+        if (std::find(reviewers.begin(), reviewers.end(), reviewer) == reviewers.end()) {
+            events.emplace_back(ReviewEventType::UNASSIGNED, reviewer, prId);
+        }
+    }
+    for (const auto& reviewer : reviewers) {
+        if (std::find(previous.begin(), previous.end(), reviewer) == previous.end()) {
+            events.emplace_back(ReviewEventType::ASSIGNED, reviewer, prId);
+        }
+    }
+    
+    success = success && writeOutbox(events) && notifyEvents(events);
+    if (!endTransaction(success)) {
+        return false;
+    }
+    
+    recordWrite();
+    scope.release();
+    publishEvents(events);
     return true;
 }
 
-std::vector<PullRequest> Database::getPRsByReviewer(const std::string& userId) {
+std::vector<PullRequest> Database::getPRsByReviewer(const std::string& userId, bool openOnly) {
+    if (cache_) {
+        uint64_t cacheVersion = cache_->version();
+        auto prs = cache_->getReviews(userId);
+        if (!prs) {
+            int shard = shardForUser(userId);
+            prs = shard == ShardRouter::NOT_FOUND ? std::vector<PullRequest>() :
+                withReadConnection(readLsn(), [&](PGconn* conn) {
+                    return queryPRsByReviewer(conn, userId, false);
+                }, shard);
+            cache_->putReviews(userId, *prs, cacheVersion);
+        }
+        std::vector<PullRequest> result;
+        if (prs) {
+            for (auto& pr : *prs) {
+                if (!openOnly || !pr.isMerged()) {
+                    result.push_back(std::move(pr));
+                }
+            }
+        }
+        return result;
+    }
+    int shard = shardForUser(userId);
+    if (shard == ShardRouter::NOT_FOUND) return {};
+    return withReadConnection(readLsn(), [&](PGconn* conn) {
+        return queryPRsByReviewer(conn, userId, openOnly);
+    }, shard);
+}
+
+std::pmr::vector<PullRequestSummary> Database::getReviewSummaries(const std::string& userId, bool openOnly,
+                                                                  std::pmr::memory_resource* arena) {
+    std::pmr::vector<PullRequestSummary> summaries(arena);
+    if (cache_) {
+        if (!cache_->copyReviews(userId, openOnly, summaries)) {
+            for (const auto& pr : getPRsByReviewer(userId, openOnly)) {
+                summaries.emplace_back(pr.id, pr.name, pr.author_id, pr.status);
+            }
+        }
+        return summaries;
+    }
+
+    int shard = shardForUser(userId);
+    if (shard == ShardRouter::NOT_FOUND) return summaries;
+    const char* params[1] = {userId.c_str()};
+    return withReadConnection(readLsn(), [&](PGconn* conn) {
+        std::pmr::vector<PullRequestSummary> rows(arena);
+        // Open PRs are never archived, so only the full list reads the archive.
+        PGresult* res = PQexecParams(conn,
+            openOnly
+                ? "SELECT p.id, p.name, p.author_id, p.status "
+                  "FROM pull_requests p "
+                  "JOIN pr_reviewers pr ON p.id = pr.pr_id AND pr.archived = false "
+                  "WHERE pr.reviewer_id = $1 AND p.archived = false AND p.status = 'OPEN'"
+                : "SELECT p.id, p.name, p.author_id, p.status "
+                  "FROM pull_requests p "
+                  "JOIN pr_reviewers pr ON p.id = pr.pr_id AND pr.archived = p.archived "
+                  "WHERE pr.reviewer_id = $1",
+            1, nullptr, params, nullptr, nullptr, 0);
+        if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+            rows.reserve(PQntuples(res));
+            for (int i = 0; i < PQntuples(res); i++) {
+                rows.emplace_back(
+                    PQgetvalue(res, i, 0),
+                    PQgetvalue(res, i, 1),
+                    PQgetvalue(res, i, 2),
+                    PullRequest::stringToStatus(PQgetvalue(res, i, 3))
+                );
+            }
+        }
+        PQclear(res);
+        return rows;
+    }, shard);
+}
+
+std::vector<PullRequest> Database::queryPRsByReviewer(PGconn* conn, const std::string& userId, bool openOnly) {
     const char* params[1] = {userId.c_str()};
     
-    PGresult* res = PQexecParams(connection_,
-        "SELECT p.id, p.name, p.author_id, p.status "
-        "FROM pull_requests p "
-        "JOIN pr_reviewers pr ON p.id = pr.pr_id "
-        "WHERE pr.reviewer_id = $1", 1, nullptr, params, nullptr, nullptr, 0);
+    PGresult* res = PQexecParams(conn,
+        openOnly
+            ? "SELECT p.id, p.name, p.author_id, p.status "
+              "FROM pull_requests p "
+              "JOIN pr_reviewers pr ON p.id = pr.pr_id AND pr.archived = false "
+              "WHERE pr.reviewer_id = $1 AND p.archived = false AND p.status = 'OPEN'"
+            : "SELECT p.id, p.name, p.author_id, p.status "
+              "FROM pull_requests p "
+              "JOIN pr_reviewers pr ON p.id = pr.pr_id AND pr.archived = p.archived "
+              "WHERE pr.reviewer_id = $1",
+        1, nullptr, params, nullptr, nullptr, 0);
     
     std::vector<PullRequest> prs;
     if (PQresultStatus(res) == PGRES_TUPLES_OK) {
@@ -305,14 +1022,61 @@ std::vector<PullRequest> Database::getPRsByReviewer(const std::string& userId) {
     return prs;
 }
 
+std::unordered_map<std::string, PullRequest> Database::getPullRequests(const std::vector<std::string>& prIds) {
+    std::string ids = textArray(prIds);
+    const char* params[1] = {ids.c_str()};
+
+    std::unordered_map<std::string, PullRequest> prs;
+    for (int shard = 0; shard < shards_.shardCount(); shard++) {
+        ShardScope scope(*this, shard);
+        std::vector<std::string> found;
+        PGresult* prRes = PQexecParams(conn(),
+            "SELECT id, name, author_id, status, created_at, merged_at "
+            "FROM pull_requests WHERE id = ANY($1::varchar[])",
+            1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
+        if (PQresultStatus(prRes) == PGRES_TUPLES_OK) {
+            for (int i = 0; i < PQntuples(prRes); i++) {
+                RowDecoder row(prRes, i);
+                PullRequest pr(row.text(0), row.text(1), row.text(2), PullRequest::stringToStatus(row.text(3)));
+                pr.created_at = row.timestamp(4);
+                pr.merged_at = row.timestamp(5);
+                shards_.rememberPullRequest(pr.id, shard);
+                found.push_back(pr.id);
+                prs.emplace(pr.id, std::move(pr));
+            }
+        }
+        PQclear(prRes);
+        if (found.empty()) continue;
+
+        std::string foundIds = textArray(found);
+        const char* revParams[1] = {foundIds.c_str()};
+        PGresult* revRes = PQexecParams(conn(),
+            "SELECT pr_id, reviewer_id FROM pr_reviewers WHERE pr_id = ANY($1::varchar[]) ORDER BY id",
+            1, nullptr, revParams, nullptr, nullptr, 0);
+        if (PQresultStatus(revRes) == PGRES_TUPLES_OK) {
+            for (int i = 0; i < PQntuples(revRes); i++) {
+                auto it = prs.find(PQgetvalue(revRes, i, 0));
+                if (it != prs.end()) {
+                    it->second.assigned_reviewers.push_back(PQgetvalue(revRes, i, 1));
+                }
+            }
+        }
+        PQclear(revRes);
+    }
+    return prs;
+}
+
 bool Database::isPRMerged(const std::string& prId) {
     auto pr = getPullRequest(prId);
     return pr && pr->isMerged();
 }
 
 bool Database::prExists(const std::string& prId) {
+    int shard = shardForPullRequest(prId);
+    if (shard == ShardRouter::NOT_FOUND) return false;
+    ShardScope scope(*this, shard);
     const char* params[1] = {prId.c_str()};
-    PGresult* res = PQexecParams(connection_,
+    PGresult* res = PQexecParams(conn(),
         "SELECT id FROM pull_requests WHERE id = $1", 1, nullptr, params, nullptr, nullptr, 0);
     
     bool exists = PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0;
@@ -323,41 +1087,152 @@ bool Database::prExists(const std::string& prId) {
 bool Database::bulkDeactivateUsers(const std::vector<std::string>& userIds) {
     if (userIds.empty()) return true;
     
-    PGresult* beginRes = PQexec(connection_, "BEGIN");
-    PQclear(beginRes);
+    // One transaction per shard; a failed shard stops the remaining ones.
+    std::map<int, std::vector<std::string>> byShard;
+    for (const auto& userId : userIds) {
+        int shard = shardForUser(userId);
+        if (shard != ShardRouter::NOT_FOUND) {
+            byShard[shard].push_back(userId);
+        }
+    }
     
-    try {
-        for (const auto& userId : userIds) {
-            const char* params[2] = { "false", userId.c_str() };
-            PGresult* res = PQexecParams(connection_,
-                "UPDATE users SET is_active = $1 WHERE id = $2",
-                2, nullptr, params, nullptr, nullptr, 0);
-            
-            if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+    bool success = true;
+    for (const auto& group : byShard) {
+        ShardScope scope(*this, group.first);
+        PGresult* beginRes = PQexec(conn(), "BEGIN");
+        PQclear(beginRes);
+        
+        try {
+            for (const auto& userId : group.second) {
+                const char* params[2] = { "false", userId.c_str() };
+                PGresult* res = PQexecParams(conn(),
+                    "UPDATE users SET is_active = $1 WHERE id = $2",
+                    2, nullptr, params, nullptr, nullptr, 0);
+                
+                if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+                    PQclear(res);
+                    throw std::runtime_error("Failed to deactivate user: " + userId);
+                }
                 PQclear(res);
-                throw std::runtime_error("Failed to deactivate user: " + userId);
             }
-            PQclear(res);
+            
+            PGresult* commitRes = PQexec(conn(), "COMMIT");
+            success = PQresultStatus(commitRes) == PGRES_COMMAND_OK;
+            PQclear(commitRes);
+            if (success) {
+                recordWrite();
+            }
+            
+        } catch (const std::exception& e) {
+            PGresult* rollbackRes = PQexec(conn(), "ROLLBACK");
+            PQclear(rollbackRes);
+            success = false;
         }
-        
-        PGresult* commitRes = PQexec(connection_, "COMMIT");
-        bool success = PQresultStatus(commitRes) == PGRES_COMMAND_OK;
-        PQclear(commitRes);
-        return success;
-        
-    } catch (const std::exception& e) {
-        PGresult* rollbackRes = PQexec(connection_, "ROLLBACK");
-        PQclear(rollbackRes);
+        if (!success) break;
+    }
+    
+    if (cache_) {
+        for (const auto& userId : userIds) {
+            cache_->invalidateUser(userId);
+        }
+    }
+    return success;
+}
+
+bool Database::getOpenTeamPullRequests(const std::string& teamName, std::vector<PullRequest>& prs) {
+    ShardScope scope(*this, shardForTeam(teamName));
+    const char* params[1] = { teamName.c_str() };
+    PGresult* res = PQexecParams(conn(),
+        "SELECT p.id, p.name, p.author_id, r.reviewer_id "
+        "FROM pull_requests p "
+        "JOIN users a ON a.id = p.author_id "
+        "JOIN teams t ON t.id = a.team_id "
+        "LEFT JOIN pr_reviewers r ON r.pr_id = p.id AND r.archived = false "
+        "WHERE t.name = $1 AND p.status = 'OPEN' AND p.archived = false "
+        "ORDER BY p.id",
+        1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        PQclear(res);
         return false;
     }
+
+    prs.clear();
+    for (int i = 0; i < PQntuples(res); i++) {
+        RowDecoder row(res, i);
+        std::string prId = row.text(0);
+        if (prs.empty() || prs.back().id != prId) {
+            prs.emplace_back(prId, row.text(1), row.text(2));
+        }
+        if (!row.isNull(3)) {
+            prs.back().assigned_reviewers.push_back(row.text(3));
+        }
+    }
+    PQclear(res);
+    return true;
+}
+
+// Applies every move in one statement. If any reviewer row is gone or its PR
+// was merged since the plan was made, nothing is applied.
+bool Database::applyReviewerMoves(const std::vector<ReviewerMove>& moves) {
+    if (moves.empty()) return true;
+    // Moves come from one team's plan, so they all share the first PR's shard.
+    int shard = shardForPullRequest(moves.front().pr_id);
+    if (shard == ShardRouter::NOT_FOUND) return false;
+    ShardScope scope(*this, shard);
+
+    std::vector<std::string> prIds;
+    std::vector<std::string> fromIds;
+    std::vector<std::string> toIds;
+    for (const auto& move : moves) {
+        prIds.push_back(move.pr_id);
+        fromIds.push_back(move.from_reviewer);
+        toIds.push_back(move.to_reviewer);
+    }
+    std::string prArray = textArray(prIds);
+    std::string fromArray = textArray(fromIds);
+    std::string toArray = textArray(toIds);
+    const char* params[3] = { prArray.c_str(), fromArray.c_str(), toArray.c_str() };
+
+    PGresult* res = PQexec(conn(), "BEGIN");
+    PQclear(res);
+
+    res = PQexecParams(conn(),
+        "UPDATE pr_reviewers r SET reviewer_id = m.to_id, assigned_at = CURRENT_TIMESTAMP "
+        "FROM unnest($1::varchar[], $2::varchar[], $3::varchar[]) AS m(pr_id, from_id, to_id), "
+        "pull_requests p "
+        "WHERE r.pr_id = m.pr_id AND r.reviewer_id = m.from_id AND r.archived = false "
+        "AND p.id = r.pr_id AND p.archived = false AND p.status = 'OPEN'",
+        3, nullptr, params, nullptr, nullptr, 0);
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK &&
+                   std::atoi(PQcmdTuples(res)) == static_cast<int>(moves.size());
+    PQclear(res);
+
+    std::vector<ReviewEvent> events;
+    for (const auto& move : moves) {
+        events.emplace_back(ReviewEventType::UNASSIGNED, move.from_reviewer, move.pr_id);
+        events.emplace_back(ReviewEventType::ASSIGNED, move.to_reviewer, move.pr_id);
+    }
+
+    success = success && writeOutbox(events) && notifyEvents(events);
+    if (!endTransaction(success)) {
+        return false;
+    }
+
+    recordWrite();
+    scope.release();
+    publishEvents(events);
+    return true;
 }
 
 std::vector<std::pair<std::string, std::string>> Database::getOpenPRsWithReviewer(const std::string& reviewerId) {
+    int shard = shardForUser(reviewerId);
+    if (shard == ShardRouter::NOT_FOUND) return {};
+    ShardScope scope(*this, shard);
     const char* params[1] = { reviewerId.c_str() };
-    PGresult* res = PQexecParams(connection_,
+    PGresult* res = PQexecParams(conn(),
         "SELECT pr.id, pr.name FROM pull_requests pr "
-        "JOIN pr_reviewers prr ON pr.id = prr.pr_id "
-        "WHERE prr.reviewer_id = $1 AND pr.status = 'OPEN'",
+        "JOIN pr_reviewers prr ON pr.id = prr.pr_id AND prr.archived = false "
+        "WHERE prr.reviewer_id = $1 AND pr.archived = false AND pr.status = 'OPEN'",
         1, nullptr, params, nullptr, nullptr, 0);
     
     std::vector<std::pair<std::string, std::string>> result;
@@ -371,4 +1246,786 @@ std::vector<std::pair<std::string, std::string>> Database::getOpenPRsWithReviewe
     }
     PQclear(res);
     return result;
-}
\ No newline at end of file
+}
+
+int Database::archiveMergedPullRequests(int shard, int olderThanDays, int batchSize) {
+    std::string days = std::to_string(olderThanDays);
+    std::string limit = std::to_string(batchSize);
+    const char* selectParams[2] = { days.c_str(), limit.c_str() };
+
+    ShardScope scope(*this, shard);
+    PGresult* beginRes = PQexec(conn(), "BEGIN");
+    PQclear(beginRes);
+
+    PGresult* idsRes = PQexecParams(conn(),
+        "SELECT COALESCE(array_agg(id), '{}') FROM ("
+        "  SELECT id FROM pull_requests "
+        "  WHERE archived = false AND status = 'MERGED' "
+        "  AND merged_at < CURRENT_TIMESTAMP - $1::int * INTERVAL '1 day' "
+        "  LIMIT $2::int FOR UPDATE SKIP LOCKED"
+        ") batch",
+        2, nullptr, selectParams, nullptr, nullptr, 0);
+
+    if (PQresultStatus(idsRes) != PGRES_TUPLES_OK || PQntuples(idsRes) == 0) {
+        PQclear(idsRes);
+        PGresult* rollbackRes = PQexec(conn(), "ROLLBACK");
+        PQclear(rollbackRes);
+        return -1;
+    }
+
+    std::string ids = PQgetvalue(idsRes, 0, 0);
+    PQclear(idsRes);
+    const char* moveParams[1] = { ids.c_str() };
+
+    PGresult* reviewersRes = PQexecParams(conn(),
+        "UPDATE pr_reviewers SET archived = true "
+        "WHERE archived = false AND pr_id = ANY($1::varchar[])",
+        1, nullptr, moveParams, nullptr, nullptr, 0);
+    bool success = PQresultStatus(reviewersRes) == PGRES_COMMAND_OK;
+    PQclear(reviewersRes);
+
+    int archived = 0;
+    if (success) {
+        PGresult* prsRes = PQexecParams(conn(),
+            "UPDATE pull_requests SET archived = true "
+            "WHERE archived = false AND id = ANY($1::varchar[])",
+            1, nullptr, moveParams, nullptr, nullptr, 0);
+        success = PQresultStatus(prsRes) == PGRES_COMMAND_OK;
+        if (success) {
+            archived = std::atoi(PQcmdTuples(prsRes));
+        }
+        PQclear(prsRes);
+    }
+
+    PGresult* endRes = PQexec(conn(), success ? "COMMIT" : "ROLLBACK");
+    success = success && PQresultStatus(endRes) == PGRES_COMMAND_OK;
+    PQclear(endRes);
+    // Cached review lists include archived PRs, so they stay valid.
+    if (success && archived > 0) {
+        recordWrite();
+    }
+    return success ? archived : -1;
+}
+
+std::vector<OutboxEntry> Database::claimOutboxBatch(int limit, int leaseSeconds) {
+    std::string leaseStr = std::to_string(leaseSeconds);
+    std::vector<OutboxEntry> entries;
+    // Each claim starts at the next shard so a busy shard cannot starve the rest.
+    int count = shards_.shardCount();
+    int start = count > 0 ? static_cast<int>(nextOutboxShard_++ % count) : 0;
+    for (int n = 0; n < count && static_cast<int>(entries.size()) < limit; n++) {
+        int shard = (start + n) % count;
+        std::string limitStr = std::to_string(limit - static_cast<int>(entries.size()));
+        const char* params[2] = { limitStr.c_str(), leaseStr.c_str() };
+
+        ShardScope scope(*this, shard);
+        PGresult* res = PQexecParams(conn(),
+            "UPDATE review_outbox SET next_attempt_at = CURRENT_TIMESTAMP + $2::int * INTERVAL '1 second' "
+            "WHERE id IN ("
+            "  SELECT id FROM review_outbox WHERE next_attempt_at <= CURRENT_TIMESTAMP "
+            "  ORDER BY id LIMIT $1::int FOR UPDATE SKIP LOCKED"
+            ") RETURNING id, target, event_type, user_id, pr_id, "
+            "to_char(created_at, 'YYYY-MM-DD\"T\"HH24:MI:SS\"Z\"'), attempts",
+            2, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
+
+        if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+            for (int i = 0; i < PQntuples(res); i++) {
+                RowDecoder row(res, i);
+                entries.emplace_back(
+                    row.integer(0),
+                    row.text(1),
+                    row.text(2),
+                    row.text(3),
+                    row.text(4),
+                    row.text(5),
+                    static_cast<int>(row.integer(6))
+                );
+                entries.back().shard = shard;
+            }
+        }
+        PQclear(res);
+    }
+    std::sort(entries.begin(), entries.end(), [](const OutboxEntry& a, const OutboxEntry& b) {
+        return a.shard != b.shard ? a.shard < b.shard : a.id < b.id;
+    });
+    return entries;
+}
+
+std::string Database::outboxIdArray(const std::vector<OutboxEntry>& entries) {
+    std::string ids = "{";
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i > 0) ids += ",";
+        ids += std::to_string(entries[i].id);
+    }
+    return ids + "}";
+}
+
+std::string Database::textArray(const std::vector<std::string>& values) {
+    std::string array = "{";
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i > 0) array += ",";
+        array += '"';
+        for (char c : values[i]) {
+            if (c == '"' || c == '\\') array += '\\';
+            array += c;
+        }
+        array += '"';
+    }
+    return array + "}";
+}
+
+bool Database::completeOutboxEntries(const std::vector<OutboxEntry>& entries) {
+    bool success = true;
+    for (const auto& group : groupByShard(entries)) {
+        std::string ids = outboxIdArray(group.second);
+        const char* params[1] = { ids.c_str() };
+        ShardScope scope(*this, group.first);
+        PGresult* res = PQexecParams(conn(),
+            "DELETE FROM review_outbox WHERE id = ANY($1::bigint[])",
+            1, nullptr, params, nullptr, nullptr, 0);
+        success = PQresultStatus(res) == PGRES_COMMAND_OK && success;
+        PQclear(res);
+    }
+    return success;
+}
+
+bool Database::rescheduleOutboxEntries(const std::vector<OutboxEntry>& entries, int delaySeconds) {
+    std::string delay = std::to_string(delaySeconds);
+    bool success = true;
+    for (const auto& group : groupByShard(entries)) {
+        std::string ids = outboxIdArray(group.second);
+        const char* params[2] = { ids.c_str(), delay.c_str() };
+        ShardScope scope(*this, group.first);
+        PGresult* res = PQexecParams(conn(),
+            "UPDATE review_outbox SET attempts = attempts + 1, "
+            "next_attempt_at = CURRENT_TIMESTAMP + $2::int * INTERVAL '1 second' "
+            "WHERE id = ANY($1::bigint[])",
+            2, nullptr, params, nullptr, nullptr, 0);
+        success = PQresultStatus(res) == PGRES_COMMAND_OK && success;
+        PQclear(res);
+    }
+    return success;
+}
+
+bool Database::deadLetterOutboxEntries(const std::vector<OutboxEntry>& entries) {
+    bool success = true;
+    for (const auto& group : groupByShard(entries)) {
+        std::string ids = outboxIdArray(group.second);
+        const char* params[1] = { ids.c_str() };
+        ShardScope scope(*this, group.first);
+        PGresult* res = PQexecParams(conn(),
+            "WITH dead AS (DELETE FROM review_outbox WHERE id = ANY($1::bigint[]) RETURNING *) "
+            "INSERT INTO review_outbox_dead_letters "
+            "(id, target, event_type, user_id, pr_id, attempts, created_at) "
+            "SELECT id, target, event_type, user_id, pr_id, attempts + 1, created_at FROM dead",
+            1, nullptr, params, nullptr, nullptr, 0);
+        success = PQresultStatus(res) == PGRES_COMMAND_OK && success;
+        PQclear(res);
+    }
+    return success;
+}
+
+PGconn* Database::openConnection(const std::string& connectionString) {
+    PGconn* conn = PQconnectdb(connectionString.c_str());
+    if (PQstatus(conn) != CONNECTION_OK || !RowDecoder::useUtc(conn)) {
+        std::cerr << "Database connection failed: " << PQerrorMessage(conn) << std::endl;
+        PQfinish(conn);
+        return nullptr;
+    }
+    return conn;
+}
+
+// Shards are streamed one after another. A team and everything keyed by its
+// members live on a single shard, so groups never straddle two of them.
+long long Database::streamRows(const char* query, const std::function<void(PGresult*)>& onRow) {
+    long long rows = 0;
+    for (int shard = 0; shard < shards_.shardCount(); shard++) {
+        PGconn* conn = openConnection(shards_.connectionString(shard));
+        if (!conn) return -1;
+
+        if (!PQsendQueryParams(conn, query, 0, nullptr, nullptr, nullptr, nullptr, RowDecoder::BINARY) ||
+            !PQsetSingleRowMode(conn)) {
+            PQfinish(conn);
+            return -1;
+        }
+
+        bool failed = false;
+        while (PGresult* res = PQgetResult(conn)) {
+            ExecStatusType status = PQresultStatus(res);
+            if (status == PGRES_SINGLE_TUPLE) {
+                onRow(res);
+                rows++;
+            } else if (status != PGRES_TUPLES_OK) {
+                std::cerr << "Streaming query failed: " << PQresultErrorMessage(res) << std::endl;
+                failed = true;
+            }
+            PQclear(res);
+        }
+
+        PQfinish(conn);
+        if (failed) return -1;
+    }
+    return rows;
+}
+
+long long Database::streamTeamRosters(const std::function<void(Team&&)>& onTeam) {
+    std::unique_ptr<Team> current;
+    long long rows = streamRows(
+        "SELECT t.name, u.id, u.username, u.is_active "
+        "FROM teams t LEFT JOIN users u ON t.id = u.team_id "
+        "ORDER BY t.name",
+        [&](PGresult* res) {
+            RowDecoder row(res, 0);
+            std::string teamName = row.text(0);
+            if (!current || current->name != teamName) {
+                if (current) onTeam(std::move(*current));
+                current = std::make_unique<Team>(teamName);
+            }
+            if (!row.isNull(1)) {
+                current->members.emplace_back(
+                    row.text(1),
+                    row.text(2),
+                    teamName,
+                    row.boolean(3)
+                );
+            }
+        });
+    if (rows >= 0 && current) {
+        onTeam(std::move(*current));
+    }
+    return rows;
+}
+
+long long Database::streamReviewAssignments(
+    const std::function<void(const std::string&, std::vector<PullRequest>&&)>& onReviewer) {
+    std::string reviewer;
+    std::vector<PullRequest> prs;
+    long long rows = streamRows(
+        "SELECT pr.reviewer_id, p.id, p.name, p.author_id, p.status "
+        "FROM pr_reviewers pr "
+        "JOIN pull_requests p ON p.id = pr.pr_id AND p.archived = pr.archived "
+        "ORDER BY pr.reviewer_id",
+        [&](PGresult* res) {
+            std::string reviewerId = PQgetvalue(res, 0, 0);
+            if (reviewerId != reviewer) {
+                if (!reviewer.empty()) onReviewer(reviewer, std::move(prs));
+                reviewer = reviewerId;
+                prs.clear();
+            }
+            prs.emplace_back(
+                PQgetvalue(res, 0, 1),
+                PQgetvalue(res, 0, 2),
+                PQgetvalue(res, 0, 3),
+                PullRequest::stringToStatus(PQgetvalue(res, 0, 4))
+            );
+        });
+    if (rows >= 0 && !reviewer.empty()) {
+        onReviewer(reviewer, std::move(prs));
+    }
+    return rows;
+}
+
+long long Database::streamOpenReviews(
+    const std::function<void(const std::string&, const std::string&, const std::string&,
+                             std::chrono::system_clock::time_point)>& onReview) {
+    return streamRows(
+        "SELECT p.id, pr.reviewer_id, t.name, p.created_at "
+        "FROM pr_reviewers pr "
+        "JOIN pull_requests p ON p.id = pr.pr_id AND p.archived = false "
+        "JOIN users u ON u.id = pr.reviewer_id "
+        "JOIN teams t ON t.id = u.team_id "
+        "WHERE pr.archived = false AND p.status = 'OPEN'",
+        [&](PGresult* res) {
+            RowDecoder row(res, 0);
+            onReview(row.text(0), row.text(1), row.text(2), row.timestamp(3));
+        });
+}
+
+ReviewAssignmentStats Database::getReviewAssignmentStats() {
+    uint64_t minLsn = readLsn();
+    auto query = [](PGconn* conn) { return queryReviewAssignmentStats(conn); };
+    if (shards_.shardCount() <= 1) {
+        return withReadConnection(minLsn, query);
+    }
+
+    // Every shard is queried in parallel, then the lists are merged back
+    // into the single-database order.
+    std::vector<std::future<ReviewAssignmentStats>> parts;
+    for (int shard = 0; shard < shards_.shardCount(); shard++) {
+        parts.push_back(std::async(std::launch::async, [this, minLsn, query, shard]() {
+            return withReadConnection(minLsn, query, shard);
+        }));
+    }
+    ReviewAssignmentStats stats;
+    for (auto& part : parts) {
+        ReviewAssignmentStats shardStats = part.get();
+        stats.total_prs += shardStats.total_prs;
+        stats.open_prs += shardStats.open_prs;
+        stats.merged_prs += shardStats.merged_prs;
+        std::move(shardStats.user_assignments.begin(), shardStats.user_assignments.end(),
+                  std::back_inserter(stats.user_assignments));
+        std::move(shardStats.pr_assignments.begin(), shardStats.pr_assignments.end(),
+                  std::back_inserter(stats.pr_assignments));
+    }
+    std::stable_sort(stats.user_assignments.begin(), stats.user_assignments.end(),
+        [](const UserAssignmentCount& a, const UserAssignmentCount& b) {
+            return a.assignment_count > b.assignment_count;
+        });
+    std::stable_sort(stats.pr_assignments.begin(), stats.pr_assignments.end(),
+        [](const PRReviewerCount& a, const PRReviewerCount& b) { return a.created_at > b.created_at; });
+    return stats;
+}
+
+ReviewAssignmentStats Database::queryReviewAssignmentStats(PGconn* conn) {
+    ReviewAssignmentStats stats;
+
+    PGresult* countRes = PQexecParams(conn,
+        "SELECT COUNT(*), "
+        "COUNT(*) FILTER (WHERE status = 'OPEN'), "
+        "COUNT(*) FILTER (WHERE status = 'MERGED') "
+        "FROM pull_requests",
+        0, nullptr, nullptr, nullptr, nullptr, RowDecoder::BINARY);
+    if (PQresultStatus(countRes) == PGRES_TUPLES_OK && PQntuples(countRes) > 0) {
+        RowDecoder row(countRes, 0);
+        stats.total_prs = static_cast<int>(row.integer(0));
+        stats.open_prs = static_cast<int>(row.integer(1));
+        stats.merged_prs = static_cast<int>(row.integer(2));
+    }
+    PQclear(countRes);
+
+    PGresult* userRes = PQexecParams(conn,
+        "SELECT u.id, u.username, COUNT(pr.reviewer_id) as assignment_count "
+        "FROM users u LEFT JOIN pr_reviewers pr ON u.id = pr.reviewer_id "
+        "WHERE u.is_active = true "
+        "GROUP BY u.id, u.username "
+        "ORDER BY assignment_count DESC",
+        0, nullptr, nullptr, nullptr, nullptr, RowDecoder::BINARY);
+    if (PQresultStatus(userRes) == PGRES_TUPLES_OK) {
+        for (int i = 0; i < PQntuples(userRes); i++) {
+            RowDecoder row(userRes, i);
+            stats.user_assignments.emplace_back(
+                row.text(0),
+                row.text(1),
+                static_cast<int>(row.integer(2))
+            );
+        }
+    }
+    PQclear(userRes);
+
+    PGresult* prRes = PQexecParams(conn,
+        "SELECT p.id, p.name, p.status, COUNT(pr.reviewer_id) as reviewer_count, p.created_at "
+        "FROM pull_requests p LEFT JOIN pr_reviewers pr ON p.id = pr.pr_id "
+        "GROUP BY p.id, p.name, p.status, p.created_at "
+        "ORDER BY p.created_at DESC",
+        0, nullptr, nullptr, nullptr, nullptr, RowDecoder::BINARY);
+    if (PQresultStatus(prRes) == PGRES_TUPLES_OK) {
+        for (int i = 0; i < PQntuples(prRes); i++) {
+            RowDecoder row(prRes, i);
+            stats.pr_assignments.emplace_back(
+                row.text(0),
+                row.text(1),
+                row.text(2),
+                static_cast<int>(row.integer(3))
+            );
+            stats.pr_assignments.back().created_at = row.timestamp(4);
+        }
+    }
+    PQclear(prRes);
+
+    return stats;
+}
+
+int Database::claimIdempotencyKey(const std::string& key, const std::string& fingerprint,
+                                  int leaseSeconds) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    std::string lease = std::to_string(leaseSeconds);
+    const char* params[3] = { key.c_str(), fingerprint.c_str(), lease.c_str() };
+    // An unfinished claim older than the lease belongs to a node that died
+    // mid-request, so it can be taken over.
+    PGresult* res = PQexecParams(connection_,
+        "INSERT INTO idempotency_keys (key, fingerprint) VALUES ($1, $2) "
+        "ON CONFLICT (key) DO UPDATE SET fingerprint = EXCLUDED.fingerprint, "
+        "created_at = CURRENT_TIMESTAMP "
+        "WHERE idempotency_keys.status IS NULL "
+        "AND idempotency_keys.created_at < CURRENT_TIMESTAMP - $3::int * INTERVAL '1 second'",
+        3, nullptr, params, nullptr, nullptr, 0);
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+        std::cerr << "Failed to claim idempotency key: " << PQerrorMessage(connection_) << std::endl;
+        PQclear(res);
+        return -1;
+    }
+    int claimed = PQcmdTuples(res)[0] == '1' ? 1 : 0;
+    PQclear(res);
+    return claimed;
+}
+
+std::unique_ptr<IdempotencyRecord> Database::getIdempotencyRecord(const std::string& key) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    const char* params[1] = { key.c_str() };
+    PGresult* res = PQexecParams(connection_,
+        "SELECT key, fingerprint, COALESCE(status, 0), COALESCE(body, '') "
+        "FROM idempotency_keys WHERE key = $1",
+        1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
+
+    if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
+        PQclear(res);
+        return nullptr;
+    }
+
+    RowDecoder row(res, 0);
+    auto record = std::make_unique<IdempotencyRecord>(
+        row.text(0),
+        row.text(1),
+        static_cast<int>(row.integer(2)),
+        row.text(3)
+    );
+    PQclear(res);
+    return record;
+}
+
+bool Database::saveIdempotencyRecord(const IdempotencyRecord& record) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    std::string status = std::to_string(record.status);
+    const char* params[3] = { record.key.c_str(), status.c_str(), record.body.c_str() };
+    PGresult* res = PQexecParams(connection_,
+        "UPDATE idempotency_keys SET status = $2::int, body = $3 WHERE key = $1",
+        3, nullptr, params, nullptr, nullptr, 0);
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    return success;
+}
+
+bool Database::releaseIdempotencyKey(const std::string& key) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    const char* params[1] = { key.c_str() };
+    PGresult* res = PQexecParams(connection_,
+        "DELETE FROM idempotency_keys WHERE key = $1 AND status IS NULL",
+        1, nullptr, params, nullptr, nullptr, 0);
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    return success;
+}
+
+int Database::purgeIdempotencyKeys(int olderThanSeconds) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    std::string age = std::to_string(olderThanSeconds);
+    const char* params[1] = { age.c_str() };
+    PGresult* res = PQexecParams(connection_,
+        "DELETE FROM idempotency_keys "
+        "WHERE created_at < CURRENT_TIMESTAMP - $1::int * INTERVAL '1 second'",
+        1, nullptr, params, nullptr, nullptr, 0);
+    int purged = PQresultStatus(res) == PGRES_COMMAND_OK ? std::atoi(PQcmdTuples(res)) : -1;
+    PQclear(res);
+    return purged;
+}
+
+bool Database::getCodeOwnerRules(std::vector<CodeOwnerRule>& rules) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    // Rules keep the order of their first row; owners of a repeated pattern
+    // are merged into it.
+    PGresult* res = PQexec(connection_,
+        "SELECT pattern, owner_id FROM code_owners "
+        "ORDER BY MIN(id) OVER (PARTITION BY pattern), id");
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        PQclear(res);
+        return false;
+    }
+
+    rules.clear();
+    for (int i = 0; i < PQntuples(res); i++) {
+        std::string pattern = PQgetvalue(res, i, 0);
+        if (rules.empty() || rules.back().pattern != pattern) {
+            rules.emplace_back(pattern);
+        }
+        rules.back().owners.push_back(PQgetvalue(res, i, 1));
+    }
+    PQclear(res);
+    return true;
+}
+
+bool Database::replaceCodeOwnerRules(const std::vector<CodeOwnerRule>& rules) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    std::vector<std::string> patterns;
+    std::vector<std::string> owners;
+    for (const auto& rule : rules) {
+        for (const auto& owner : rule.owners) {
+            patterns.push_back(rule.pattern);
+            owners.push_back(owner);
+        }
+    }
+    std::string patternArray = textArray(patterns);
+    std::string ownerArray = textArray(owners);
+    const char* params[2] = { patternArray.c_str(), ownerArray.c_str() };
+
+    PGresult* res = PQexec(connection_, "BEGIN");
+    PQclear(res);
+
+    res = PQexec(connection_, "DELETE FROM code_owners");
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    if (success) {
+        res = PQexecParams(connection_,
+            "INSERT INTO code_owners (pattern, owner_id) "
+            "SELECT pattern, owner_id FROM unnest($1::varchar[], $2::varchar[]) "
+            "WITH ORDINALITY AS r(pattern, owner_id, n) "
+            "ORDER BY n",
+            2, nullptr, params, nullptr, nullptr, 0);
+        success = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+    }
+
+    if (!endTransaction(success)) {
+        return false;
+    }
+    recordWrite();
+    return true;
+}
+
+bool Database::getAvailabilityWindows(const std::vector<std::string>& userIds,
+                                      std::vector<AvailabilityWindow>& windows) {
+    std::string ids = textArray(userIds);
+    const char* params[1] = { ids.c_str() };
+    windows.clear();
+    for (int shard = 0; shard < shards_.shardCount(); shard++) {
+        ShardScope scope(*this, shard);
+        PGresult* res = PQexecParams(conn(),
+            "SELECT w.user_id, t.name, w.starts_at, w.ends_at, COALESCE(w.reason, '') "
+            "FROM availability_windows w "
+            "JOIN users u ON u.id = w.user_id JOIN teams t ON t.id = u.team_id "
+            "WHERE w.ends_at > (now() AT TIME ZONE 'UTC') "
+            "AND (cardinality($1::varchar[]) = 0 OR w.user_id = ANY($1::varchar[]))",
+            1, nullptr, params, nullptr, nullptr, RowDecoder::BINARY);
+        if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+            PQclear(res);
+            return false;
+        }
+
+        for (int i = 0; i < PQntuples(res); i++) {
+            RowDecoder row(res, i);
+            windows.emplace_back(row.text(0), row.text(1), row.timestamp(2), row.timestamp(3), row.text(4));
+        }
+        PQclear(res);
+    }
+    return true;
+}
+
+bool Database::replaceAvailabilityWindows(const std::vector<std::string>& userIds,
+                                          const std::vector<AvailabilityWindow>& windows) {
+    // Windows live on their user's shard; each shard gets its own transaction.
+    std::map<int, std::pair<std::vector<std::string>, std::vector<AvailabilityWindow>>> byShard;
+    std::unordered_map<std::string, int> userShards;
+    for (const auto& userId : userIds) {
+        int shard = shardForUser(userId);
+        if (shard == ShardRouter::NOT_FOUND) return false;
+        userShards[userId] = shard;
+        byShard[shard].first.push_back(userId);
+    }
+    for (const auto& window : windows) {
+        auto it = userShards.find(window.user_id);
+        if (it == userShards.end()) return false;
+        byShard[it->second].second.push_back(window);
+    }
+
+    for (const auto& group : byShard) {
+        const auto& shardUsers = group.second.first;
+        const auto& shardWindows = group.second.second;
+        std::vector<std::string> windowUsers;
+        std::vector<std::string> starts;
+        std::vector<std::string> ends;
+        std::vector<std::string> reasons;
+        for (const auto& window : shardWindows) {
+            windowUsers.push_back(window.user_id);
+            starts.push_back(std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+                window.starts_at.time_since_epoch()).count()));
+            ends.push_back(std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+                window.ends_at.time_since_epoch()).count()));
+            reasons.push_back(window.reason);
+        }
+        std::string userArray = textArray(shardUsers);
+        std::string windowUserArray = textArray(windowUsers);
+        std::string startArray = textArray(starts);
+        std::string endArray = textArray(ends);
+        std::string reasonArray = textArray(reasons);
+
+        ShardScope scope(*this, group.first);
+        PGresult* res = PQexec(conn(), "BEGIN");
+        PQclear(res);
+
+        const char* deleteParams[1] = { userArray.c_str() };
+        res = PQexecParams(conn(),
+            "DELETE FROM availability_windows WHERE user_id = ANY($1::varchar[])",
+            1, nullptr, deleteParams, nullptr, nullptr, 0);
+        bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+
+        if (success && !shardWindows.empty()) {
+            const char* insertParams[4] = {
+                windowUserArray.c_str(), startArray.c_str(), endArray.c_str(), reasonArray.c_str()
+            };
+            res = PQexecParams(conn(),
+                "INSERT INTO availability_windows (user_id, starts_at, ends_at, reason) "
+                "SELECT user_id, to_timestamp(starts_at) AT TIME ZONE 'UTC', "
+                "to_timestamp(ends_at) AT TIME ZONE 'UTC', NULLIF(reason, '') "
+                "FROM unnest($1::varchar[], $2::bigint[], $3::bigint[], $4::varchar[]) "
+                "AS w(user_id, starts_at, ends_at, reason)",
+                4, nullptr, insertParams, nullptr, nullptr, 0);
+            success = PQresultStatus(res) == PGRES_COMMAND_OK;
+            PQclear(res);
+        }
+
+        if (!endTransaction(success)) {
+            return false;
+        }
+        recordWrite();
+    }
+    if (availability_) {
+        availability_->replaceUsers(userIds, windows);
+    }
+    return true;
+}
+
+// The source transaction locks the team, its users and PRs for the whole
+// move, so writes to the team wait and reads keep going to the source until
+// the directory flips. Running nodes are told only after the source rows are
+// gone: a node that located a user or PR by probing in between would find the
+// source copy, and the notification is what drops that stale placement.
+bool Database::moveTeam(const std::string& teamName, int targetShard, std::string& error) {
+    if (targetShard < 0 || targetShard >= shards_.shardCount()) {
+        error = "shard " + std::to_string(targetShard) + " is not configured";
+        return false;
+    }
+    int sourceShard = shardForTeam(teamName);
+    if (sourceShard == targetShard) {
+        error = "team is already on shard " + std::to_string(targetShard);
+        return false;
+    }
+
+    // Leases are taken in shard order, so opposite moves cannot deadlock.
+    auto first = shards_.acquire(std::min(sourceShard, targetShard));
+    auto second = shards_.acquire(std::max(sourceShard, targetShard));
+    PGconn* source = sourceShard < targetShard ? first.get() : second.get();
+    PGconn* target = sourceShard < targetShard ? second.get() : first.get();
+
+    std::string teamId;
+    std::string crossTeam;
+    std::string users;
+    std::string prs;
+    std::string reviewers;
+    std::string windows;
+    bool success = runStep(source, "BEGIN", {}, error) &&
+        runStep(source, "SELECT id FROM teams WHERE name = $1 FOR UPDATE", { teamName }, error, &teamId);
+    if (success && teamId.empty()) {
+        error = "team not found";
+        success = false;
+    }
+    success = success &&
+        runStep(source, "SELECT id FROM users WHERE team_id = $1::int FOR UPDATE", { teamId }, error) &&
+        runStep(source,
+            "SELECT p.id FROM pull_requests p JOIN users u ON u.id = p.author_id "
+            "WHERE u.team_id = $1::int FOR UPDATE OF p",
+            { teamId }, error) &&
+        runStep(source,
+            "SELECT COUNT(*) FROM pr_reviewers r "
+            "JOIN pull_requests p ON p.id = r.pr_id AND p.archived = r.archived "
+            "JOIN users a ON a.id = p.author_id JOIN users v ON v.id = r.reviewer_id "
+            "WHERE (a.team_id IS NOT DISTINCT FROM $1::int) <> (v.team_id IS NOT DISTINCT FROM $1::int)",
+            { teamId }, error, &crossTeam);
+    if (success && crossTeam != "0") {
+        error = crossTeam + " reviewer assignments link the team with other teams";
+        success = false;
+    }
+    success = success &&
+        runStep(source, "SELECT COALESCE(json_agg(u), '[]') FROM users u WHERE u.team_id = $1::int",
+            { teamId }, error, &users) &&
+        runStep(source,
+            "SELECT COALESCE(json_agg(p), '[]') FROM pull_requests p "
+            "JOIN users u ON u.id = p.author_id WHERE u.team_id = $1::int",
+            { teamId }, error, &prs) &&
+        runStep(source,
+            "SELECT COALESCE(json_agg(r), '[]') FROM pr_reviewers r "
+            "JOIN users u ON u.id = r.reviewer_id WHERE u.team_id = $1::int",
+            { teamId }, error, &reviewers) &&
+        runStep(source,
+            "SELECT COALESCE(json_agg(w), '[]') FROM availability_windows w "
+            "JOIN users u ON u.id = w.user_id WHERE u.team_id = $1::int",
+            { teamId }, error, &windows);
+    if (!success) {
+        std::string ignored;
+        runStep(source, "ROLLBACK", {}, ignored);
+        return false;
+    }
+
+    // Serial ids are not copied; the target hands out its own.
+    success = runStep(target, "BEGIN", {}, error) &&
+        runStep(target,
+            "WITH t AS (INSERT INTO teams (name) VALUES ($1) RETURNING id) "
+            "INSERT INTO users (id, username, team_id, is_active, created_at) "
+            "SELECT u.id, u.username, t.id, u.is_active, u.created_at "
+            "FROM t, json_populate_recordset(NULL::users, $2::json) u",
+            { teamName, users }, error) &&
+        runStep(target,
+            "INSERT INTO pull_request_ids (id) SELECT id FROM json_populate_recordset(NULL::pull_requests, $1::json)",
+            { prs }, error) &&
+        runStep(target,
+            "INSERT INTO pull_requests SELECT * FROM json_populate_recordset(NULL::pull_requests, $1::json)",
+            { prs }, error) &&
+        runStep(target,
+            "INSERT INTO pr_reviewers (pr_id, reviewer_id, assigned_at, archived) "
+            "SELECT pr_id, reviewer_id, assigned_at, archived "
+            "FROM json_populate_recordset(NULL::pr_reviewers, $1::json)",
+            { reviewers }, error) &&
+        runStep(target,
+            "INSERT INTO availability_windows (user_id, starts_at, ends_at, reason, created_at) "
+            "SELECT user_id, starts_at, ends_at, reason, created_at "
+            "FROM json_populate_recordset(NULL::availability_windows, $1::json)",
+            { windows }, error) &&
+        runStep(target, "COMMIT", {}, error);
+    if (!success) {
+        std::string ignored;
+        runStep(target, "ROLLBACK", {}, ignored);
+        runStep(source, "ROLLBACK", {}, ignored);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        std::string shard = std::to_string(targetShard);
+        success = runStep(connection_,
+            "WITH prs AS ("
+            "  INSERT INTO pull_request_shards (pull_request_id, shard_id) "
+            "  SELECT id, $2::int FROM json_populate_recordset(NULL::pull_requests, $3::json) "
+            "  ON CONFLICT (pull_request_id) DO UPDATE SET shard_id = EXCLUDED.shard_id"
+            ") INSERT INTO team_shards (team_name, shard_id) VALUES ($1, $2::int) "
+            "ON CONFLICT (team_name) DO UPDATE SET shard_id = EXCLUDED.shard_id, "
+            "updated_at = CURRENT_TIMESTAMP",
+            { teamName, shard, prs }, error);
+    }
+    if (!success) {
+        std::string ignored;
+        runStep(source, "ROLLBACK", {}, ignored);
+        if (!runStep(target, "BEGIN", {}, ignored) || !dropTeamRows(target, teamName, ignored) ||
+            !runStep(target, "COMMIT", {}, ignored)) {
+            runStep(target, "ROLLBACK", {}, ignored);
+            error += "; the copy on shard " + std::to_string(targetShard) + " must be deleted by hand";
+        }
+        return false;
+    }
+
+    bool dropped = dropTeamRows(source, teamName, error) && runStep(source, "COMMIT", {}, error);
+    if (!dropped) {
+        std::string ignored;
+        runStep(source, "ROLLBACK", {}, ignored);
+        error = "team moved, but deleting it from shard " + std::to_string(sourceShard) + " failed: " + error;
+    }
+    shards_.forgetTeam(teamName);
+    std::string notifyError;
+    bool notified = false;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        notified = runStep(connection_, "SELECT notify_cache_invalidation('shard', $1)", { teamName }, notifyError);
+    }
+    if (!notified) {
+        error += std::string(dropped ? "" : "; ") + "team moved, but notifying running nodes failed: " + notifyError;
+    }
+    return dropped && notified;
+}
@@ -2,17 +2,67 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <mutex>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <memory_resource>
 #include <libpq-fe.h>
+#include "ReplicaRouter.h"
+#include "ShardRouter.h"
 #include "../models/User.h"
 #include "../models/PullRequest.h"
+#include "../models/ReviewEvent.h"
+#include "../models/OutboxEntry.h"
+#include "../models/ReviewStats.h"
+#include "../models/IdempotencyRecord.h"
+#include "../models/CodeOwnerRule.h"
+#include "../models/ReviewerMove.h"
+#include "../models/AvailabilityWindow.h"
+
+class ReviewEventBus;
+class ReviewCache;
+class AvailabilityIndex;
 
 class Database {
 public:
     static Database& getInstance();
     
-    bool connect(const std::string& connectionString);
+    // The primary is shard 0 and also holds the team_shards directory;
+    // poolSize connections are opened to it and to every further shard.
+    bool connect(const std::string& connectionString, int poolSize = 1);
+    bool connectShard(const std::string& connectionString);
+    int shardCount() const { return shards_.shardCount(); }
+    std::vector<ShardStatus> shardStatus() const { return shards_.status(); }
+    ShardLocatorStats shardLocatorStats() const { return shards_.locatorStats(); }
+    // Shard the team lives on, or ShardRouter::NOT_FOUND.
+    int teamShard(const std::string& teamName);
+    // Drops cached placements after a team moved; empty means all teams.
+    void forgetTeamShard(const std::string& teamName);
+    // Copies the team, its users, PRs, reviewer rows and availability windows
+    // to the target shard, flips the directory and deletes the source rows.
+    // Writes to the team wait until the move is done.
+    bool moveTeam(const std::string& teamName, int targetShard, std::string& error);
     void disconnect();
     bool isConnected() const;
+    bool connectReplica(const std::string& connectionString);
+    void startReplicaMonitor(std::chrono::milliseconds interval, std::chrono::milliseconds maxLag,
+                             std::chrono::milliseconds maxWait);
+    std::vector<ReplicaStatus> replicaStatus() const;
+    void noteExternalWrite(uint64_t lsn);
+    
+    // Per-request read consistency. A request carrying the LSN of an earlier
+    // write only reads from replicas that have replayed past it; the LSN of
+    // this request's own writes is reported back through sessionWriteLsn().
+    static void beginSession(const std::string& minLsn);
+    static std::string sessionWriteLsn();
+    uint64_t readPosition() const { return readLsn(); }
+    void setEventBus(ReviewEventBus* eventBus);
+    void setCache(ReviewCache* cache);
+    // Events are written to the outbox once per target; empty disables it.
+    void setOutboxTargets(std::vector<std::string> targets);
+    void setAvailability(AvailabilityIndex* availability);
     
     bool createTeam(const Team& team);
     std::unique_ptr<Team> getTeam(const std::string& teamName);
@@ -21,22 +71,120 @@ public:
     bool createOrUpdateUser(const User& user);
     bool setUserActive(const std::string& userId, bool isActive);
     std::unique_ptr<User> getUser(const std::string& userId);
+    std::unordered_map<std::string, User> getUsers(const std::vector<std::string>& userIds, uint64_t minLsn);
     std::vector<User> getActiveTeamMembers(const std::string& teamName, const std::string& excludeUserId = "");
     
     bool createPullRequest(const PullRequest& pr);
     bool mergePullRequest(const std::string& prId);
     std::unique_ptr<PullRequest> getPullRequest(const std::string& prId);
+    std::unordered_map<std::string, PullRequest> getPullRequests(const std::vector<std::string>& prIds);
     bool updatePRReviewers(const std::string& prId, const std::vector<std::string>& reviewers);
-    std::vector<PullRequest> getPRsByReviewer(const std::string& userId);
+    std::vector<PullRequest> getPRsByReviewer(const std::string& userId, bool openOnly = false);
+    std::pmr::vector<PullRequestSummary> getReviewSummaries(const std::string& userId, bool openOnly,
+                                                            std::pmr::memory_resource* arena);
     bool isPRMerged(const std::string& prId);
     bool prExists(const std::string& prId);
     bool bulkDeactivateUsers(const std::vector<std::string>& userIds);
+    bool getOpenTeamPullRequests(const std::string& teamName, std::vector<PullRequest>& prs);
+    bool applyReviewerMoves(const std::vector<ReviewerMove>& moves);
 std::vector<std::pair<std::string, std::string>> getOpenPRsWithReviewer(const std::string& reviewerId);
+    // One batch on one shard: the number archived, or -1 if the batch failed.
+    int archiveMergedPullRequests(int shard, int olderThanDays, int batchSize);
+    
+    std::vector<OutboxEntry> claimOutboxBatch(int limit, int leaseSeconds);
+    bool completeOutboxEntries(const std::vector<OutboxEntry>& entries);
+    bool rescheduleOutboxEntries(const std::vector<OutboxEntry>& entries, int delaySeconds);
+    bool deadLetterOutboxEntries(const std::vector<OutboxEntry>& entries);
+    
+    ReviewAssignmentStats getReviewAssignmentStats();
+    
+    // 1 if claimed, 0 if another request holds the key, -1 on a database error.
+    int claimIdempotencyKey(const std::string& key, const std::string& fingerprint, int leaseSeconds);
+    std::unique_ptr<IdempotencyRecord> getIdempotencyRecord(const std::string& key);
+    bool saveIdempotencyRecord(const IdempotencyRecord& record);
+    bool releaseIdempotencyKey(const std::string& key);
+    int purgeIdempotencyKeys(int olderThanSeconds);
+    
+    bool getCodeOwnerRules(std::vector<CodeOwnerRule>& rules);
+    bool replaceCodeOwnerRules(const std::vector<CodeOwnerRule>& rules);
+    
+    // Windows that have not ended yet; all users when userIds is empty.
+    bool getAvailabilityWindows(const std::vector<std::string>& userIds, std::vector<AvailabilityWindow>& windows);
+    bool replaceAvailabilityWindows(const std::vector<std::string>& userIds,
+                                    const std::vector<AvailabilityWindow>& windows);
+    
+    // Bulk loaders for cache warm-up. Each runs on its own connection in
+    // single-row mode, so they can run in parallel with each other and with requests.
+    long long streamTeamRosters(const std::function<void(Team&&)>& onTeam);
+    long long streamReviewAssignments(
+        const std::function<void(const std::string&, std::vector<PullRequest>&&)>& onReviewer);
+    long long streamOpenReviews(
+        const std::function<void(const std::string&, const std::string&, const std::string&,
+                                 std::chrono::system_clock::time_point)>& onReview);
 
 private:
+    // Binds the calling thread to a pooled connection of one shard; conn()
+    // returns it. A nested scope for the same shard reuses the binding.
+    // Nothing may wait for a second shard while bound, so callbacks out of
+    // the database layer (event subscribers) run after release().
+    class ShardScope {
+    public:
+        ShardScope(Database& db, int shard);
+        ~ShardScope();
+        void release();
+        ShardScope(const ShardScope&) = delete;
+        ShardScope& operator=(const ShardScope&) = delete;
+    private:
+        ShardRouter::Lease lease_;
+        int previousShard_;
+        PGconn* previousConnection_;
+    };
+
     Database() = default;
     PGconn* connection_ = nullptr;
+    std::string connectionString_;
+    mutable std::recursive_mutex mutex_;
+    ReviewEventBus* eventBus_ = nullptr;
+    ReviewCache* cache_ = nullptr;
+    std::vector<std::string> outboxTargets_;
+    AvailabilityIndex* availability_ = nullptr;
+    
+    ShardRouter shards_;
+    int shardPoolSize_ = 1;
+    static thread_local int boundShard_;
+    static thread_local PGconn* boundConnection_;
+    
+    ReplicaRouter replicas_;
+    std::chrono::milliseconds replicaWait_{50};
+    std::atomic<uint64_t> lastWriteLsn_{0};
+    std::atomic<unsigned> nextOutboxShard_{0};
+    static thread_local uint64_t sessionLsn_;
+    static thread_local bool sessionWrote_;
     
+    // Outside a ShardScope this is the catalog connection, guarded by mutex_.
+    PGconn* conn() const { return boundConnection_ ? boundConnection_ : connection_; }
+    int shardForTeam(const std::string& teamName, bool* known = nullptr);
+    int shardForUser(const std::string& userId);
+    int shardForPullRequest(const std::string& prId);
+    int probeShards(const char* query, const std::string& key);
     int getTeamId(const std::string& teamName);
+    std::unique_ptr<Team> queryTeam(PGconn* conn, const std::string& teamName);
+    std::unique_ptr<User> queryUser(PGconn* conn, const std::string& userId);
+    std::vector<PullRequest> queryPRsByReviewer(PGconn* conn, const std::string& userId, bool openOnly);
+    std::vector<User> queryActiveTeamMembers(const std::string& teamName, const std::string& excludeUserId);
+    uint64_t currentWalLsn();
+    void recordWrite();
+    uint64_t readLsn() const;
+    template <typename Query>
+    auto withReadConnection(uint64_t minLsn, Query&& query, int shard = 0) -> decltype(query(nullptr));
+    static ReviewAssignmentStats queryReviewAssignmentStats(PGconn* conn);
+    PGconn* openConnection(const std::string& connectionString);
+    long long streamRows(const char* query, const std::function<void(PGresult*)>& onRow);
+    void publishEvents(const std::vector<ReviewEvent>& events);
+    bool writeOutbox(const std::vector<ReviewEvent>& events);
+    bool notifyEvents(const std::vector<ReviewEvent>& events);
+    bool endTransaction(bool commit);
+    std::string outboxIdArray(const std::vector<OutboxEntry>& entries);
+    static std::string textArray(const std::vector<std::string>& values);
     std::string timeToString(const std::chrono::system_clock::time_point& time);
 };
\ No newline at end of file
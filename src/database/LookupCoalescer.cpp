@@ -0,0 +1,20 @@
+#include "LookupCoalescer.h"
+
+LookupCoalescer::LookupCoalescer(Database& db, size_t maxBatch, std::chrono::microseconds maxWait)
+    : database_(db),
+      pullRequests_([&db](const std::vector<std::string>& ids, uint64_t) {
+                        return db.getPullRequests(ids);
+                    }, maxBatch, maxWait),
+      users_([&db](const std::vector<std::string>& ids, uint64_t minLsn) {
+                 return db.getUsers(ids, minLsn);
+             }, maxBatch, maxWait) {}
+
+std::unique_ptr<PullRequest> LookupCoalescer::getPullRequest(const std::string& prId) {
+    auto pr = pullRequests_.load(prId);
+    return pr ? std::make_unique<PullRequest>(std::move(*pr)) : nullptr;
+}
+
+std::unique_ptr<User> LookupCoalescer::getUser(const std::string& userId) {
+    auto user = users_.load(userId, database_.readPosition());
+    return user ? std::make_unique<User>(std::move(*user)) : nullptr;
+}
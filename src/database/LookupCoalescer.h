@@ -0,0 +1,26 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include "BatchLoader.h"
+#include "Database.h"
+
+// Coalesced getPullRequest/getUser for request handlers. Concurrent lookups
+// share one `= ANY($1)` query per batch instead of one query per call.
+// Not for use inside Database methods, which may already hold its lock.
+class LookupCoalescer {
+public:
+    explicit LookupCoalescer(Database& db, size_t maxBatch = 64,
+                             std::chrono::microseconds maxWait = std::chrono::microseconds(2000));
+
+    std::unique_ptr<PullRequest> getPullRequest(const std::string& prId);
+    std::unique_ptr<User> getUser(const std::string& userId);
+
+    BatchLoaderStats pullRequestStats() const { return pullRequests_.stats(); }
+    BatchLoaderStats userStats() const { return users_.stats(); }
+
+private:
+    Database& database_;
+    BatchLoader<std::string, PullRequest> pullRequests_;
+    BatchLoader<std::string, User> users_;
+};
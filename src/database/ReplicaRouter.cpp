@@ -0,0 +1,165 @@
+#include "ReplicaRouter.h"
+#include "RowDecoder.h"
+#include <cstdio>
+#include <iostream>
+
+ReplicaRouter::~ReplicaRouter() {
+    stop();
+}
+
+bool ReplicaRouter::addReplica(const std::string& connectionString) {
+    auto replica = std::make_unique<Replica>();
+    replica->connectionString = connectionString;
+    replica->conn = PQconnectdb(connectionString.c_str());
+    if (PQstatus(replica->conn) != CONNECTION_OK || !RowDecoder::useUtc(replica->conn)) {
+        std::cerr << "Replica connection failed: " << PQerrorMessage(replica->conn) << std::endl;
+        PQfinish(replica->conn);
+        return false;
+    }
+    replica->host = PQhost(replica->conn);
+    replica->replayLsn = queryReplayLsn(replica->conn);
+    replica->healthy = true;
+    std::cout << "Connected to PostgreSQL replica " << replica->host << std::endl;
+    replicas_.push_back(std::move(replica));
+    return true;
+}
+
+uint64_t ReplicaRouter::parseLsn(const char* text) {
+    if (!text || !*text) return 0;
+    unsigned int hi = 0, lo = 0;
+    if (std::sscanf(text, "%X/%X", &hi, &lo) != 2) return 0;
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+std::string ReplicaRouter::formatLsn(uint64_t lsn) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%X/%X",
+                  static_cast<unsigned int>(lsn >> 32), static_cast<unsigned int>(lsn));
+    return buf;
+}
+
+uint64_t ReplicaRouter::queryReplayLsn(PGconn* conn) {
+    PGresult* res = PQexecParams(conn, "SELECT pg_last_wal_replay_lsn()",
+                                 0, nullptr, nullptr, nullptr, nullptr, RowDecoder::BINARY);
+    uint64_t lsn = 0;
+    if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
+        lsn = RowDecoder(res, 0).lsn(0);
+    }
+    PQclear(res);
+    return lsn;
+}
+
+ReplicaRouter::Lease ReplicaRouter::acquire(uint64_t minLsn, std::chrono::milliseconds maxWait) {
+    if (replicas_.empty()) return {};
+    size_t start = next_++;
+
+    // Prefer a replica already known to be caught up.
+    Replica* lagging = nullptr;
+    for (size_t i = 0; i < replicas_.size(); i++) {
+        Replica& replica = *replicas_[(start + i) % replicas_.size()];
+        if (!replica.healthy) continue;
+        if (replica.replayLsn >= minLsn) {
+            return Lease(replica.conn, std::unique_lock<std::mutex>(replica.mutex));
+        }
+        if (!lagging) lagging = &replica;
+    }
+    if (!lagging || maxWait.count() == 0) return {};
+
+    std::unique_lock<std::mutex> lock(lagging->mutex);
+    auto deadline = std::chrono::steady_clock::now() + maxWait;
+    while (true) {
+        uint64_t replayed = queryReplayLsn(lagging->conn);
+        if (replayed > lagging->replayLsn) {
+            lagging->replayLsn = replayed;
+        }
+        if (replayed >= minLsn) {
+            return Lease(lagging->conn, std::move(lock));
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return {};
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+void ReplicaRouter::checkReplica(Replica& replica, uint64_t primaryLsn, std::chrono::milliseconds maxLag) {
+    std::lock_guard<std::mutex> lock(replica.mutex);
+    if (PQstatus(replica.conn) != CONNECTION_OK) {
+        PQreset(replica.conn);
+        if (PQstatus(replica.conn) != CONNECTION_OK || !RowDecoder::useUtc(replica.conn)) {
+            replica.healthy = false;
+            return;
+        }
+    }
+
+    PGresult* res = PQexecParams(replica.conn,
+        "SELECT pg_is_in_recovery(), pg_last_wal_replay_lsn(), "
+        "COALESCE(EXTRACT(EPOCH FROM now() - pg_last_xact_replay_timestamp()) * 1000, 0)::bigint",
+        0, nullptr, nullptr, nullptr, nullptr, RowDecoder::BINARY);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
+        PQclear(res);
+        replica.healthy = false;
+        return;
+    }
+
+    RowDecoder row(res, 0);
+    bool inRecovery = row.boolean(0);
+    uint64_t replayed = row.lsn(1);
+    // An idle primary makes replay timestamps age; a fully replayed replica has no lag.
+    long long lagMs = replayed >= primaryLsn ? 0 : row.integer(2);
+    PQclear(res);
+
+    replica.replayLsn = replayed;
+    replica.lagMs = lagMs;
+    replica.healthy = inRecovery && lagMs <= maxLag.count();
+}
+
+void ReplicaRouter::startMonitor(std::function<uint64_t()> primaryLsn,
+                                 std::chrono::milliseconds interval, std::chrono::milliseconds maxLag) {
+    if (monitor_.joinable() || replicas_.empty()) return;
+    stopping_ = false;
+    monitor_ = std::thread([this, primaryLsn, interval, maxLag]() {
+        std::unique_lock<std::mutex> lock(monitorMutex_);
+        while (!stopping_) {
+            lock.unlock();
+            uint64_t lsn = primaryLsn();
+            for (auto& replica : replicas_) {
+                checkReplica(*replica, lsn, maxLag);
+            }
+            lock.lock();
+            monitorWakeup_.wait_for(lock, interval, [this] { return stopping_; });
+        }
+    });
+}
+
+void ReplicaRouter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(monitorMutex_);
+        stopping_ = true;
+    }
+    monitorWakeup_.notify_all();
+    if (monitor_.joinable()) {
+        monitor_.join();
+    }
+    for (auto& replica : replicas_) {
+        std::lock_guard<std::mutex> lock(replica->mutex);
+        if (replica->conn) {
+            PQfinish(replica->conn);
+            replica->conn = nullptr;
+        }
+        replica->healthy = false;
+    }
+}
+
+std::vector<ReplicaStatus> ReplicaRouter::status() const {
+    std::vector<ReplicaStatus> result;
+    for (const auto& replica : replicas_) {
+        ReplicaStatus status;
+        status.host = replica->host;
+        status.healthy = replica->healthy;
+        status.replayLsn = replica->replayLsn;
+        status.lagMs = replica->lagMs;
+        result.push_back(status);
+    }
+    return result;
+}
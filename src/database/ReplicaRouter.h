@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <libpq-fe.h>
+
+struct ReplicaStatus {
+    std::string host;
+    bool healthy = false;
+    uint64_t replayLsn = 0;
+    long long lagMs = 0;
+};
+
+// Read-only standby connections. A replica serves a read only if it is healthy
+// and has replayed at least the LSN the caller needs; otherwise the caller
+// falls back to the primary.
+class ReplicaRouter {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(PGconn* conn, std::unique_lock<std::mutex> lock) : conn_(conn), lock_(std::move(lock)) {}
+        PGconn* get() const { return conn_; }
+        explicit operator bool() const { return conn_ != nullptr; }
+    private:
+        PGconn* conn_ = nullptr;
+        std::unique_lock<std::mutex> lock_;
+    };
+
+    ~ReplicaRouter();
+
+    bool addReplica(const std::string& connectionString);
+    bool hasReplicas() const { return !replicas_.empty(); }
+
+    Lease acquire(uint64_t minLsn, std::chrono::milliseconds maxWait);
+
+    void startMonitor(std::function<uint64_t()> primaryLsn,
+                      std::chrono::milliseconds interval, std::chrono::milliseconds maxLag);
+    void stop();
+
+    std::vector<ReplicaStatus> status() const;
+
+    static uint64_t parseLsn(const char* text);
+    static std::string formatLsn(uint64_t lsn);
+
+private:
+    struct Replica {
+        std::string connectionString;
+        std::string host;
+        PGconn* conn = nullptr;
+        std::mutex mutex;
+        std::atomic<bool> healthy{false};
+        std::atomic<uint64_t> replayLsn{0};
+        std::atomic<long long> lagMs{0};
+    };
+
+    std::vector<std::unique_ptr<Replica>> replicas_;
+    std::atomic<size_t> next_{0};
+
+    std::thread monitor_;
+    std::mutex monitorMutex_;
+    std::condition_variable monitorWakeup_;
+    bool stopping_ = false;
+
+    static uint64_t queryReplayLsn(PGconn* conn);
+    void checkReplica(Replica& replica, uint64_t primaryLsn, std::chrono::milliseconds maxLag);
+};
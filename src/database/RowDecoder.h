@@ -0,0 +1,77 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <libpq-fe.h>
+
+// Typed access to one row of a result fetched in binary format
+// (resultFormat = 1). Values are read straight from their big-endian wire
+// form instead of being printed by the server and parsed back here.
+class RowDecoder {
+public:
+    static constexpr int BINARY = 1;
+
+    RowDecoder(const PGresult* res, int row) : res_(res), row_(row) {}
+
+    // TIMESTAMP columns hold CURRENT_TIMESTAMP in the writing session's time
+    // zone and timestamp() reads them as UTC, so every connection is pinned
+    // to UTC right after it opens (and after a reset).
+    static bool useUtc(PGconn* conn) {
+        PGresult* res = PQexec(conn, "SET TIME ZONE 'UTC'");
+        bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+        return success;
+    }
+
+    bool isNull(int col) const {
+        return PQgetisnull(res_, row_, col);
+    }
+
+    std::string text(int col) const {
+        return std::string(PQgetvalue(res_, row_, col), PQgetlength(res_, row_, col));
+    }
+
+    // int2, int4 and int8 columns; the width comes from the value length.
+    int64_t integer(int col) const {
+        if (isNull(col)) return 0;
+        int length = PQgetlength(res_, row_, col);
+        uint64_t raw = readBigEndian(PQgetvalue(res_, row_, col), length);
+        switch (length) {
+            case 2: return static_cast<int16_t>(raw);
+            case 4: return static_cast<int32_t>(raw);
+            default: return static_cast<int64_t>(raw);
+        }
+    }
+
+    // pg_lsn: the 64-bit WAL position that the text form prints as "%X/%X".
+    uint64_t lsn(int col) const {
+        return isNull(col) ? 0 : readBigEndian(PQgetvalue(res_, row_, col), 8);
+    }
+
+    bool boolean(int col) const {
+        return !isNull(col) && PQgetvalue(res_, row_, col)[0] != 0;
+    }
+
+    // timestamp/timestamptz: microseconds since 2000-01-01 00:00:00 UTC.
+    // NULL decodes to the default (epoch) time_point.
+    std::chrono::system_clock::time_point timestamp(int col) const {
+        if (isNull(col)) return {};
+        int64_t micros = static_cast<int64_t>(readBigEndian(PQgetvalue(res_, row_, col), 8));
+        return std::chrono::system_clock::time_point(
+            std::chrono::seconds(POSTGRES_EPOCH_UNIX_SECONDS) + std::chrono::microseconds(micros));
+    }
+
+private:
+    static constexpr int64_t POSTGRES_EPOCH_UNIX_SECONDS = 946684800;
+
+    const PGresult* res_;
+    int row_;
+
+    static uint64_t readBigEndian(const char* data, int length) {
+        uint64_t value = 0;
+        for (int i = 0; i < length; i++) {
+            value = (value << 8) | static_cast<unsigned char>(data[i]);
+        }
+        return value;
+    }
+};
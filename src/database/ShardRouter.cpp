@@ -0,0 +1,132 @@
+#include "ShardRouter.h"
+#include "RowDecoder.h"
+#include <algorithm>
+#include <iostream>
+
+ShardRouter::~ShardRouter() {
+    closeAll();
+}
+
+bool ShardRouter::addShard(const std::string& connectionString, int poolSize) {
+    auto shard = std::make_unique<Shard>();
+    shard->connectionString = connectionString;
+    for (int i = 0; i < std::max(1, poolSize); i++) {
+        auto pooled = std::make_unique<PooledConnection>();
+        pooled->conn = PQconnectdb(connectionString.c_str());
+        if (PQstatus(pooled->conn) != CONNECTION_OK || !RowDecoder::useUtc(pooled->conn)) {
+            std::cerr << "Shard connection failed: " << PQerrorMessage(pooled->conn) << std::endl;
+            PQfinish(pooled->conn);
+            for (auto& opened : shard->pool) {
+                PQfinish(opened->conn);
+            }
+            return false;
+        }
+        shard->pool.push_back(std::move(pooled));
+    }
+    shard->host = PQhost(shard->pool.front()->conn);
+
+    int id = static_cast<int>(shards_.size());
+    for (int v = 0; v < VIRTUAL_NODES; v++) {
+        ring_[hash("shard-" + std::to_string(id) + "#" + std::to_string(v))] = id;
+    }
+    shards_.push_back(std::move(shard));
+    return true;
+}
+
+void ShardRouter::closeAll() {
+    for (auto& shard : shards_) {
+        for (auto& pooled : shard->pool) {
+            std::lock_guard<std::mutex> lock(pooled->mutex);
+            if (pooled->conn) {
+                PQfinish(pooled->conn);
+                pooled->conn = nullptr;
+            }
+        }
+    }
+}
+
+ShardRouter::Lease ShardRouter::acquire(int shardId) {
+    Shard& shard = *shards_[shardId];
+    size_t start = shard.next++;
+    shard.leases++;
+    for (size_t i = 0; i < shard.pool.size(); i++) {
+        PooledConnection& pooled = *shard.pool[(start + i) % shard.pool.size()];
+        std::unique_lock<std::mutex> lock(pooled.mutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            return Lease(pooled.conn, std::move(lock));
+        }
+    }
+    shard.waits++;
+    PooledConnection& pooled = *shard.pool[start % shard.pool.size()];
+    return Lease(pooled.conn, std::unique_lock<std::mutex>(pooled.mutex));
+}
+
+int ShardRouter::placeTeam(const std::string& teamName) const {
+    if (ring_.empty()) return 0;
+    auto it = ring_.lower_bound(hash(teamName));
+    return it == ring_.end() ? ring_.begin()->second : it->second;
+}
+
+void ShardRouter::forgetTeam(const std::string& teamName) {
+    if (teamName.empty()) {
+        teams_.clear();
+    } else {
+        teams_.erase(teamName);
+    }
+    users_.clear();
+    pullRequests_.clear();
+}
+
+int ShardRouter::lookup(LruCache<std::string, int>& cache, const std::string& key) {
+    auto shard = cache.get(key);
+    if (!shard) {
+        misses_++;
+        return NOT_FOUND;
+    }
+    hits_++;
+    return *shard;
+}
+
+std::vector<ShardStatus> ShardRouter::status() const {
+    std::vector<ShardStatus> result;
+    for (size_t i = 0; i < shards_.size(); i++) {
+        const Shard& shard = *shards_[i];
+        ShardStatus status;
+        status.id = static_cast<int>(i);
+        status.host = shard.host;
+        status.poolSize = shard.pool.size();
+        for (const auto& pooled : shard.pool) {
+            std::unique_lock<std::mutex> lock(pooled->mutex, std::try_to_lock);
+            if (!lock.owns_lock()) status.busy++;
+        }
+        status.leases = shard.leases;
+        status.waits = shard.waits;
+        result.push_back(status);
+    }
+    return result;
+}
+
+ShardLocatorStats ShardRouter::locatorStats() const {
+    ShardLocatorStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.probes = probes_;
+    stats.teams = teams_.size();
+    stats.users = users_.size();
+    stats.pullRequests = pullRequests_.size();
+    return stats;
+}
+
+// FNV-1a followed by a 64-bit finalizer, so the ring positions of similar
+// names ("shard-1#1", "shard-1#2") are spread out.
+uint64_t ShardRouter::hash(const std::string& value) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : value) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
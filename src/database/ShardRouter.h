@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <libpq-fe.h>
+#include "../cache/LruCache.h"
+
+struct ShardStatus {
+    int id = 0;
+    std::string host;
+    size_t poolSize = 0;
+    size_t busy = 0;
+    uint64_t leases = 0;
+    uint64_t waits = 0;
+};
+
+struct ShardLocatorStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t probes = 0;
+    size_t teams = 0;
+    size_t users = 0;
+    size_t pullRequests = 0;
+};
+
+// Team-keyed shards. Shard 0 is the primary and also holds the team_shards
+// directory; new teams are placed on a consistent-hash ring and recorded
+// there, teams missing from the directory predate sharding and live on
+// shard 0. Each shard has its own pool of connections. The locator caches
+// team, user and PR placements; users are found by probing every shard on a
+// miss, PRs through the pull_request_shards directory on shard 0.
+class ShardRouter {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(PGconn* conn, std::unique_lock<std::mutex> lock) : conn_(conn), lock_(std::move(lock)) {}
+        PGconn* get() const { return conn_; }
+        explicit operator bool() const { return conn_ != nullptr; }
+    private:
+        PGconn* conn_ = nullptr;
+        std::unique_lock<std::mutex> lock_;
+    };
+
+    static constexpr int NOT_FOUND = -1;
+
+    explicit ShardRouter(size_t locatorCapacity = 100000)
+        : teams_(locatorCapacity), users_(locatorCapacity), pullRequests_(locatorCapacity) {}
+    ~ShardRouter();
+
+    // Shards are numbered in the order they are added.
+    bool addShard(const std::string& connectionString, int poolSize);
+    void closeAll();
+    int shardCount() const { return static_cast<int>(shards_.size()); }
+    const std::string& connectionString(int shard) const { return shards_[shard]->connectionString; }
+
+    Lease acquire(int shard);
+    int placeTeam(const std::string& teamName) const;
+
+    int cachedTeam(const std::string& teamName) { return lookup(teams_, teamName); }
+    int cachedUser(const std::string& userId) { return lookup(users_, userId); }
+    int cachedPullRequest(const std::string& prId) { return lookup(pullRequests_, prId); }
+    // With a single shard there is nothing to locate, so nothing is kept.
+    void rememberTeam(const std::string& teamName, int shard) {
+        if (shards_.size() > 1) teams_.put(teamName, shard);
+    }
+    void rememberUser(const std::string& userId, int shard) {
+        if (shards_.size() > 1) users_.put(userId, shard);
+    }
+    void rememberPullRequest(const std::string& prId, int shard) {
+        if (shards_.size() > 1) pullRequests_.put(prId, shard);
+    }
+    void forgetUser(const std::string& userId) { users_.erase(userId); }
+    void forgetPullRequest(const std::string& prId) { pullRequests_.erase(prId); }
+    // A moved team takes its users and PRs along; their entries are not
+    // indexed by team, so all of them are dropped. An empty name drops
+    // every team as well.
+    void forgetTeam(const std::string& teamName);
+    void noteProbe() { probes_++; }
+
+    std::vector<ShardStatus> status() const;
+    ShardLocatorStats locatorStats() const;
+
+private:
+    struct PooledConnection {
+        PGconn* conn = nullptr;
+        std::mutex mutex;
+    };
+
+    struct Shard {
+        std::string connectionString;
+        std::string host;
+        std::vector<std::unique_ptr<PooledConnection>> pool;
+        std::atomic<size_t> next{0};
+        std::atomic<uint64_t> leases{0};
+        std::atomic<uint64_t> waits{0};
+    };
+
+    static constexpr int VIRTUAL_NODES = 64;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::map<uint64_t, int> ring_;
+
+    LruCache<std::string, int> teams_;
+    LruCache<std::string, int> users_;
+    LruCache<std::string, int> pullRequests_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> probes_{0};
+
+    int lookup(LruCache<std::string, int>& cache, const std::string& key);
+    static uint64_t hash(const std::string& value);
+};
@@ -0,0 +1,62 @@
+#include "RequestArena.h"
+
+namespace {
+const size_t INITIAL_BLOCK_SIZE = 64 * 1024;
+}
+
+std::atomic<uint64_t> RequestArena::totalRequests_{0};
+std::atomic<uint64_t> RequestArena::totalAllocations_{0};
+std::atomic<uint64_t> RequestArena::totalBytes_{0};
+std::atomic<uint64_t> RequestArena::totalUpstreamAllocations_{0};
+std::atomic<uint64_t> RequestArena::peakRequestBytes_{0};
+
+RequestArena& RequestArena::current() {
+    thread_local RequestArena arena;
+    return arena;
+}
+
+RequestArena::RequestArena()
+    : initialBlock_(INITIAL_BLOCK_SIZE),
+      upstream_(std::pmr::new_delete_resource(), upstreamAllocations_, upstreamBytes_),
+      arena_(initialBlock_.data(), initialBlock_.size(), &upstream_),
+      counted_(&arena_, allocations_, bytes_) {}
+
+void RequestArena::reset() {
+    if (allocations_ > 0) {
+        totalRequests_++;
+        totalAllocations_ += allocations_;
+        totalBytes_ += bytes_;
+        totalUpstreamAllocations_ += upstreamAllocations_;
+        uint64_t peak = peakRequestBytes_;
+        while (bytes_ > peak && !peakRequestBytes_.compare_exchange_weak(peak, bytes_)) {}
+    }
+    arena_.release();
+    allocations_ = 0;
+    bytes_ = 0;
+    upstreamAllocations_ = 0;
+    upstreamBytes_ = 0;
+}
+
+RequestArenaStats RequestArena::stats() {
+    RequestArenaStats stats;
+    stats.requests = totalRequests_;
+    stats.allocations = totalAllocations_;
+    stats.bytes = totalBytes_;
+    stats.upstreamAllocations = totalUpstreamAllocations_;
+    stats.peakRequestBytes = peakRequestBytes_;
+    return stats;
+}
+
+void* RequestArena::CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    allocations_++;
+    bytes_ += bytes;
+    return target_->allocate(bytes, alignment);
+}
+
+void RequestArena::CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    target_->deallocate(p, bytes, alignment);
+}
+
+bool RequestArena::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+struct RequestArenaStats {
+    uint64_t requests = 0;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t upstreamAllocations = 0;
+    uint64_t peakRequestBytes = 0;
+};
+
+// Per-thread monotonic arena for objects that live exactly as long as one
+// request. Allocations are pointer bumps into a reused block; reset() drops
+// everything at once. Only the overflow past the initial block reaches malloc.
+class RequestArena {
+public:
+    static RequestArena& current();
+
+    std::pmr::memory_resource* resource() { return &counted_; }
+    void reset();
+
+    static RequestArenaStats stats();
+
+private:
+    // Forwards to another resource while counting what passes through.
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        CountingResource(std::pmr::memory_resource* target, uint64_t& allocations, uint64_t& bytes)
+            : target_(target), allocations_(allocations), bytes_(bytes) {}
+
+    private:
+        std::pmr::memory_resource* target_;
+        uint64_t& allocations_;
+        uint64_t& bytes_;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    RequestArena();
+
+    uint64_t allocations_ = 0;
+    uint64_t bytes_ = 0;
+    uint64_t upstreamAllocations_ = 0;
+    uint64_t upstreamBytes_ = 0;
+
+    std::vector<std::byte> initialBlock_;
+    CountingResource upstream_;
+    std::pmr::monotonic_buffer_resource arena_;
+    CountingResource counted_;
+
+    static std::atomic<uint64_t> totalRequests_;
+    static std::atomic<uint64_t> totalAllocations_;
+    static std::atomic<uint64_t> totalBytes_;
+    static std::atomic<uint64_t> totalUpstreamAllocations_;
+    static std::atomic<uint64_t> peakRequestBytes_;
+};
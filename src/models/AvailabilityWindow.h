@@ -0,0 +1,21 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+// A span [starts_at, ends_at) during which the user gets no new reviews.
+struct AvailabilityWindow {
+    std::string user_id;
+    std::string team_name;
+    std::chrono::system_clock::time_point starts_at;
+    std::chrono::system_clock::time_point ends_at;
+    std::string reason;
+
+    AvailabilityWindow(const std::string& user_id, const std::string& team_name,
+                       std::chrono::system_clock::time_point starts_at,
+                       std::chrono::system_clock::time_point ends_at, const std::string& reason = "")
+        : user_id(user_id), team_name(team_name), starts_at(starts_at), ends_at(ends_at), reason(reason) {}
+
+    bool covers(std::chrono::system_clock::time_point time) const {
+        return starts_at <= time && time < ends_at;
+    }
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct CodeOwnerRule {
+    std::string pattern;
+    std::vector<std::string> owners;
+
+    CodeOwnerRule(const std::string& pattern, const std::vector<std::string>& owners = {})
+        : pattern(pattern), owners(owners) {}
+};
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+
+struct IdempotencyRecord {
+    std::string key;
+    std::string fingerprint;
+    int status;
+    std::string body;
+
+    IdempotencyRecord(const std::string& key, const std::string& fingerprint,
+                      int status = 0, const std::string& body = "")
+        : key(key), fingerprint(fingerprint), status(status), body(body) {}
+
+    bool isInProgress() const { return status == 0; }
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+struct OutboxEntry {
+    int64_t id;
+    std::string target;
+    std::string event_type;
+    std::string user_id;
+    std::string pr_id;
+    std::string created_at;
+    int attempts;
+    int shard = 0;
+
+    OutboxEntry(int64_t id, const std::string& target, const std::string& event_type,
+                const std::string& user_id, const std::string& pr_id, const std::string& created_at,
+                int attempts)
+        : id(id), target(target), event_type(event_type), user_id(user_id), pr_id(pr_id),
+          created_at(created_at), attempts(attempts) {}
+};
@@ -2,6 +2,8 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <memory_resource>
+#include <string_view>
 
 enum class PRStatus {
     OPEN,
@@ -42,4 +44,30 @@ struct PullRequestShort {
     PullRequestShort(const std::string& id, const std::string& name, 
                      const std::string& author_id, PRStatus status)
         : id(id), name(name), author_id(author_id), status(status) {}
-};
\ No newline at end of file
+};
+
+// Allocator-aware summary for per-request lists; built on the request arena
+// so none of its strings outlive the request or touch the global heap.
+struct PullRequestSummary {
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::string id;
+    std::pmr::string name;
+    std::pmr::string author_id;
+    PRStatus status;
+
+    PullRequestSummary(std::string_view id, std::string_view name, std::string_view author_id,
+                       PRStatus status, const allocator_type& alloc = {})
+        : id(id, alloc), name(name, alloc), author_id(author_id, alloc), status(status) {}
+
+    PullRequestSummary(const PullRequestSummary& other, const allocator_type& alloc = {})
+        : id(other.id, alloc), name(other.name, alloc), author_id(other.author_id, alloc),
+          status(other.status) {}
+
+    PullRequestSummary(PullRequestSummary&& other, const allocator_type& alloc)
+        : id(std::move(other.id), alloc), name(std::move(other.name), alloc),
+          author_id(std::move(other.author_id), alloc), status(other.status) {}
+
+    bool isMerged() const { return status == PRStatus::MERGED; }
+    const char* getStatusString() const { return status == PRStatus::OPEN ? "OPEN" : "MERGED"; }
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <chrono>
+
+enum class ReviewEventType {
+    ASSIGNED,
+    UNASSIGNED,
+    MERGED,
+    RESYNC
+};
+
+struct ReviewEvent {
+    ReviewEventType type;
+    std::string user_id;
+    std::string pr_id;
+    std::chrono::system_clock::time_point occurred_at;
+
+    ReviewEvent(ReviewEventType type, const std::string& user_id, const std::string& pr_id)
+        : type(type), user_id(user_id), pr_id(pr_id),
+          occurred_at(std::chrono::system_clock::now()) {}
+
+    std::string getTypeString() const {
+        switch (type) {
+            case ReviewEventType::ASSIGNED: return "ASSIGNED";
+            case ReviewEventType::UNASSIGNED: return "UNASSIGNED";
+            case ReviewEventType::MERGED: return "MERGED";
+            case ReviewEventType::RESYNC: return "RESYNC";
+        }
+        return "";
+    }
+};
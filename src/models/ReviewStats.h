@@ -0,0 +1,33 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct UserAssignmentCount {
+    std::string user_id;
+    std::string username;
+    int assignment_count;
+
+    UserAssignmentCount(const std::string& user_id, const std::string& username, int assignment_count)
+        : user_id(user_id), username(username), assignment_count(assignment_count) {}
+};
+
+struct PRReviewerCount {
+    std::string pr_id;
+    std::string name;
+    std::string status;
+    int reviewer_count;
+    std::chrono::system_clock::time_point created_at{};
+
+    PRReviewerCount(const std::string& pr_id, const std::string& name,
+                    const std::string& status, int reviewer_count)
+        : pr_id(pr_id), name(name), status(status), reviewer_count(reviewer_count) {}
+};
+
+struct ReviewAssignmentStats {
+    int total_prs = 0;
+    int open_prs = 0;
+    int merged_prs = 0;
+    std::vector<UserAssignmentCount> user_assignments;
+    std::vector<PRReviewerCount> pr_assignments;
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+
+struct ReviewerMove {
+    std::string pr_id;
+    std::string from_reviewer;
+    std::string to_reviewer;
+
+    ReviewerMove(const std::string& pr_id, const std::string& from_reviewer, const std::string& to_reviewer)
+        : pr_id(pr_id), from_reviewer(from_reviewer), to_reviewer(to_reviewer) {}
+};
@@ -0,0 +1,89 @@
+#include "AdmissionController.h"
+#include <algorithm>
+
+void AdmissionController::configureRoute(const std::string& route, const RouteLimit& limit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto state = std::make_unique<RouteState>();
+    state->config = limit;
+    state->limit = limit.initialLimit;
+    routes_[route] = std::move(state);
+}
+
+bool AdmissionController::isLimited(const std::string& route) const {
+    return routes_.count(route) > 0;
+}
+
+AdmissionController::Decision AdmissionController::acquire(const std::string& route) {
+    auto it = routes_.find(route);
+    if (it == routes_.end()) {
+        return Decision::ADMITTED;
+    }
+    RouteState& state = *it->second;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto hasSlot = [&state] { return state.inFlight < static_cast<int>(state.limit); };
+
+    if (!hasSlot()) {
+        if (state.queued >= state.config.maxQueue || parked_ >= maxParked_) {
+            state.rejected++;
+            return Decision::QUEUE_FULL;
+        }
+        state.queued++;
+        parked_++;
+        bool admitted = state.slotFreed.wait_for(lock, state.config.maxWait, hasSlot);
+        parked_--;
+        state.queued--;
+        if (!admitted) {
+            state.timedOut++;
+            return Decision::TIMED_OUT;
+        }
+    }
+
+    state.inFlight++;
+    state.admitted++;
+    return Decision::ADMITTED;
+}
+
+void AdmissionController::release(const std::string& route, std::chrono::steady_clock::duration latency) {
+    auto it = routes_.find(route);
+    if (it == routes_.end()) return;
+    RouteState& state = *it->second;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state.inFlight--;
+
+        if (latency <= state.config.latencyTarget) {
+            if (++state.windowSuccesses >= static_cast<int>(state.limit)) {
+                state.limit = std::min<double>(state.limit + 1, state.config.maxLimit);
+                state.windowSuccesses = 0;
+            }
+        } else {
+            state.limit = std::max<double>(state.limit * 0.75, state.config.minLimit);
+            state.windowSuccesses = 0;
+        }
+    }
+    state.slotFreed.notify_one();
+}
+
+int AdmissionController::parked() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return parked_;
+}
+
+std::vector<RouteAdmissionStats> AdmissionController::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<RouteAdmissionStats> result;
+    for (const auto& [route, state] : routes_) {
+        RouteAdmissionStats stats;
+        stats.route = route;
+        stats.limit = static_cast<int>(state->limit);
+        stats.inFlight = state->inFlight;
+        stats.queued = state->queued;
+        stats.admitted = state->admitted;
+        stats.rejected = state->rejected;
+        stats.timedOut = state->timedOut;
+        result.push_back(stats);
+    }
+    return result;
+}
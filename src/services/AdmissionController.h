@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct RouteLimit {
+    int initialLimit = 4;
+    int minLimit = 1;
+    int maxLimit = 16;
+    int maxQueue = 2;
+    std::chrono::milliseconds maxWait{100};
+    std::chrono::milliseconds latencyTarget{250};
+};
+
+struct RouteAdmissionStats {
+    std::string route;
+    int limit = 0;
+    int inFlight = 0;
+    int queued = 0;
+    uint64_t admitted = 0;
+    uint64_t rejected = 0;
+    uint64_t timedOut = 0;
+};
+
+// Per-route concurrency limiter. Routes that are not configured are never
+// limited. Limits adapt AIMD-style: one step up after a full window of requests
+// under the latency target, a multiplicative cut on each slow request.
+// A queued request parks its server worker, so the number of parked requests
+// is also capped across all routes; past the cap requests are rejected at once
+// and the remaining workers stay free for unlimited routes.
+class AdmissionController {
+public:
+    enum class Decision {
+        ADMITTED,
+        QUEUE_FULL,
+        TIMED_OUT
+    };
+
+    explicit AdmissionController(int maxParked = 2) : maxParked_(maxParked) {}
+
+    void configureRoute(const std::string& route, const RouteLimit& limit);
+    bool isLimited(const std::string& route) const;
+
+    Decision acquire(const std::string& route);
+    void release(const std::string& route, std::chrono::steady_clock::duration latency);
+
+    std::vector<RouteAdmissionStats> stats() const;
+    int parked() const;
+    int maxParked() const { return maxParked_; }
+
+private:
+    struct RouteState {
+        RouteLimit config;
+        double limit;
+        int inFlight = 0;
+        int queued = 0;
+        int windowSuccesses = 0;
+        uint64_t admitted = 0;
+        uint64_t rejected = 0;
+        uint64_t timedOut = 0;
+        std::condition_variable slotFreed;
+    };
+
+    std::unordered_map<std::string, std::unique_ptr<RouteState>> routes_;
+    const int maxParked_;
+    int parked_ = 0;
+    mutable std::mutex mutex_;
+};
@@ -0,0 +1,290 @@
+#include "ArrowStreamWriter.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Arrow format constants (Schema.fbs, Message.fbs).
+const int16_t METADATA_V5 = 4;
+const uint8_t HEADER_SCHEMA = 1;
+const uint8_t HEADER_DICTIONARY_BATCH = 2;
+const uint8_t HEADER_RECORD_BATCH = 3;
+const uint8_t TYPE_INT = 2;
+const uint8_t TYPE_UTF8 = 5;
+const uint8_t TYPE_BOOL = 6;
+const uint8_t TYPE_TIMESTAMP = 10;
+const int16_t UNIT_MICROSECOND = 2;
+
+// Minimal FlatBuffers builder for the Arrow metadata. Like the reference
+// builder it fills the buffer back to front, so every object is created
+// before the objects that refer to it; object handles are distances from
+// the end of the buffer.
+class FlatBuilder {
+public:
+    uint32_t size() const { return static_cast<uint32_t>(data_.size()); }
+
+    template <typename T>
+    void scalar(T value) {
+        align(sizeof(T), sizeof(T));
+        char bytes[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); i++) {
+            bytes[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff);
+        }
+        data_.insert(0, bytes, sizeof(T));
+    }
+
+    void reference(uint32_t target) {
+        align(4, 4);
+        scalar<uint32_t>(size() + 4 - target);
+    }
+
+    uint32_t string(const std::string& value) {
+        align(value.size() + 1, 4);
+        data_.insert(0, 1, '\0');
+        data_.insert(0, value);
+        scalar<uint32_t>(static_cast<uint32_t>(value.size()));
+        return size();
+    }
+
+    uint32_t referenceVector(const std::vector<uint32_t>& targets) {
+        for (auto it = targets.rbegin(); it != targets.rend(); ++it) {
+            reference(*it);
+        }
+        scalar<uint32_t>(static_cast<uint32_t>(targets.size()));
+        return size();
+    }
+
+    // Vector of structs made of two longs (FieldNode, Buffer).
+    uint32_t pairVector(const std::vector<std::pair<int64_t, int64_t>>& items) {
+        align(items.size() * 16, 8);
+        for (auto it = items.rbegin(); it != items.rend(); ++it) {
+            scalar<int64_t>(it->second);
+            scalar<int64_t>(it->first);
+        }
+        scalar<uint32_t>(static_cast<uint32_t>(items.size()));
+        return size();
+    }
+
+    void startTable() {
+        fields_.clear();
+        tableStart_ = size();
+    }
+
+    template <typename T>
+    void addScalar(uint16_t field, T value) {
+        scalar(value);
+        fields_.emplace_back(field, size());
+    }
+
+    void addReference(uint16_t field, uint32_t target) {
+        reference(target);
+        fields_.emplace_back(field, size());
+    }
+
+    uint32_t endTable() {
+        scalar<int32_t>(0);
+        uint32_t table = size();
+
+        uint16_t slots = 0;
+        for (const auto& [field, offset] : fields_) {
+            slots = std::max<uint16_t>(slots, field + 1);
+        }
+        std::vector<uint16_t> vtable(slots, 0);
+        for (const auto& [field, offset] : fields_) {
+            vtable[field] = static_cast<uint16_t>(table - offset);
+        }
+        for (auto it = vtable.rbegin(); it != vtable.rend(); ++it) {
+            scalar<uint16_t>(*it);
+        }
+        scalar<uint16_t>(static_cast<uint16_t>(table - tableStart_));
+        scalar<uint16_t>(static_cast<uint16_t>((slots + 2) * 2));
+
+        // The table starts with the signed distance back to its vtable.
+        int32_t toVtable = static_cast<int32_t>(size() - table);
+        for (int i = 0; i < 4; i++) {
+            data_[size() - table + i] = static_cast<char>((static_cast<uint32_t>(toVtable) >> (8 * i)) & 0xff);
+        }
+        return table;
+    }
+
+    std::string finish(uint32_t root) {
+        align(4, 8);
+        reference(root);
+        return std::move(data_);
+    }
+
+private:
+    std::string data_;
+    std::vector<std::pair<uint16_t, uint32_t>> fields_;
+    uint32_t tableStart_ = 0;
+
+    void align(size_t bytes, size_t alignment) {
+        size_t padding = (alignment - (data_.size() + bytes) % alignment) % alignment;
+        data_.insert(0, padding, '\0');
+    }
+};
+
+uint32_t emptyTable(FlatBuilder& fb) {
+    fb.startTable();
+    return fb.endTable();
+}
+
+uint32_t intType(FlatBuilder& fb, int32_t bitWidth, bool isSigned) {
+    fb.startTable();
+    fb.addScalar<int32_t>(0, bitWidth);
+    fb.addScalar<uint8_t>(1, isSigned);
+    return fb.endTable();
+}
+
+uint32_t field(FlatBuilder& fb, const ArrowStreamWriter::Field& spec) {
+    uint32_t name = fb.string(spec.name);
+
+    uint8_t typeType = TYPE_UTF8;
+    uint32_t type = 0;
+    switch (spec.type) {
+        case ArrowStreamWriter::Type::UTF8:
+            type = emptyTable(fb);
+            break;
+        case ArrowStreamWriter::Type::INT64:
+            typeType = TYPE_INT;
+            type = intType(fb, 64, true);
+            break;
+        case ArrowStreamWriter::Type::TIMESTAMP_MICROS:
+            typeType = TYPE_TIMESTAMP;
+            fb.startTable();
+            fb.addScalar<int16_t>(0, UNIT_MICROSECOND);
+            type = fb.endTable();
+            break;
+        case ArrowStreamWriter::Type::BOOL:
+            typeType = TYPE_BOOL;
+            type = emptyTable(fb);
+            break;
+    }
+
+    uint32_t dictionary = 0;
+    if (spec.dictionaryId >= 0) {
+        uint32_t indexType = intType(fb, 32, true);
+        fb.startTable();
+        fb.addScalar<int64_t>(0, spec.dictionaryId);
+        fb.addReference(1, indexType);
+        dictionary = fb.endTable();
+    }
+    uint32_t children = fb.referenceVector({});
+
+    fb.startTable();
+    fb.addReference(0, name);
+    fb.addScalar<uint8_t>(1, spec.nullable);
+    fb.addScalar<uint8_t>(2, typeType);
+    fb.addReference(3, type);
+    if (spec.dictionaryId >= 0) {
+        fb.addReference(4, dictionary);
+    }
+    fb.addReference(5, children);
+    return fb.endTable();
+}
+
+int64_t padded(int64_t length) {
+    return (length + 7) & ~int64_t(7);
+}
+
+// RecordBatch table; buffer offsets are laid out as writeMessage writes them.
+uint32_t recordBatch(FlatBuilder& fb, int64_t rows, const std::vector<ArrowStreamWriter::Array>& columns,
+                     int64_t& bodyLength) {
+    std::vector<std::pair<int64_t, int64_t>> nodes;
+    std::vector<std::pair<int64_t, int64_t>> buffers;
+    bodyLength = 0;
+    for (const auto& column : columns) {
+        nodes.emplace_back(column.length, column.nullCount);
+        for (const auto& buffer : column.buffers) {
+            buffers.emplace_back(bodyLength, static_cast<int64_t>(buffer.size()));
+            bodyLength += padded(buffer.size());
+        }
+    }
+    uint32_t nodeVector = fb.pairVector(nodes);
+    uint32_t bufferVector = fb.pairVector(buffers);
+
+    fb.startTable();
+    fb.addScalar<int64_t>(0, rows);
+    fb.addReference(1, nodeVector);
+    fb.addReference(2, bufferVector);
+    return fb.endTable();
+}
+
+std::string message(FlatBuilder& fb, uint8_t headerType, uint32_t header, int64_t bodyLength) {
+    fb.startTable();
+    fb.addScalar<int64_t>(3, bodyLength);
+    fb.addReference(2, header);
+    fb.addScalar<int16_t>(0, METADATA_V5);
+    fb.addScalar<uint8_t>(1, headerType);
+    return fb.finish(fb.endTable());
+}
+
+std::vector<std::string_view> bodyOf(const std::vector<ArrowStreamWriter::Array>& columns) {
+    std::vector<std::string_view> body;
+    for (const auto& column : columns) {
+        body.insert(body.end(), column.buffers.begin(), column.buffers.end());
+    }
+    return body;
+}
+
+void putU32(std::ostream& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+void pad(std::ostream& out, size_t length) {
+    static const char zeros[8] = {};
+    out.write(zeros, padded(length) - length);
+}
+
+}
+
+void ArrowStreamWriter::writeSchema(const std::vector<Field>& fields) {
+    FlatBuilder fb;
+    std::vector<uint32_t> fieldTables;
+    for (const auto& spec : fields) {
+        fieldTables.push_back(field(fb, spec));
+    }
+    uint32_t fieldVector = fb.referenceVector(fieldTables);
+    fb.startTable();
+    fb.addReference(1, fieldVector);
+    fb.addScalar<int16_t>(0, 0);
+    uint32_t schema = fb.endTable();
+    writeMessage(message(fb, HEADER_SCHEMA, schema, 0), {});
+}
+
+void ArrowStreamWriter::writeDictionary(int64_t id, const Array& values, bool isDelta) {
+    FlatBuilder fb;
+    int64_t bodyLength = 0;
+    uint32_t data = recordBatch(fb, values.length, {values}, bodyLength);
+    fb.startTable();
+    fb.addScalar<int64_t>(0, id);
+    fb.addReference(1, data);
+    fb.addScalar<uint8_t>(2, isDelta);
+    uint32_t batch = fb.endTable();
+    writeMessage(message(fb, HEADER_DICTIONARY_BATCH, batch, bodyLength), values.buffers);
+}
+
+void ArrowStreamWriter::writeRecordBatch(int64_t rows, const std::vector<Array>& columns) {
+    FlatBuilder fb;
+    int64_t bodyLength = 0;
+    uint32_t batch = recordBatch(fb, rows, columns, bodyLength);
+    writeMessage(message(fb, HEADER_RECORD_BATCH, batch, bodyLength), bodyOf(columns));
+}
+
+void ArrowStreamWriter::writeEnd() {
+    putU32(out_, 0xffffffff);
+    putU32(out_, 0);
+}
+
+void ArrowStreamWriter::writeMessage(const std::string& metadata, const std::vector<std::string_view>& body) {
+    // Continuation marker and metadata length, metadata padded to 8 bytes,
+    // then the body buffers, each padded to 8 bytes.
+    putU32(out_, 0xffffffff);
+    putU32(out_, static_cast<uint32_t>(padded(metadata.size())));
+    out_.write(metadata.data(), metadata.size());
+    pad(out_, metadata.size());
+    for (const auto& buffer : body) {
+        out_.write(buffer.data(), buffer.size());
+        pad(out_, buffer.size());
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Writes the Arrow IPC streaming format: a schema message, dictionary and
+// record batch messages, then the end-of-stream marker. The output opens with
+// pyarrow.ipc.open_stream, DuckDB, polars or any other Arrow reader. Only the
+// types the exporter needs are supported; buffers are little-endian and
+// passed in Arrow's own layout.
+class ArrowStreamWriter {
+public:
+    enum class Type {
+        UTF8,
+        INT64,
+        TIMESTAMP_MICROS,
+        BOOL
+    };
+
+    struct Field {
+        std::string name;
+        Type type;
+        bool nullable = true;
+        // Dictionary-encoded with int32 indices when not negative.
+        int64_t dictionaryId = -1;
+    };
+
+    // One column of a batch: validity bitmap first, then the type's buffers
+    // (UTF8: int32 offsets and data; dictionary columns: int32 indices).
+    struct Array {
+        int64_t length = 0;
+        int64_t nullCount = 0;
+        std::vector<std::string_view> buffers;
+    };
+
+    explicit ArrowStreamWriter(std::ostream& out) : out_(out) {}
+
+    void writeSchema(const std::vector<Field>& fields);
+    // values is a UTF8 array; a delta appends to the dictionary sent so far.
+    void writeDictionary(int64_t id, const Array& values, bool isDelta);
+    void writeRecordBatch(int64_t rows, const std::vector<Array>& columns);
+    void writeEnd();
+
+private:
+    std::ostream& out_;
+
+    void writeMessage(const std::string& metadata, const std::vector<std::string_view>& body);
+};
@@ -0,0 +1,87 @@
+#include "CacheWarmer.h"
+#include <iostream>
+
+CacheWarmer::~CacheWarmer() {
+    stop();
+}
+
+void CacheWarmer::start() {
+    if (worker_.joinable()) return;
+    stopping_ = false;
+    worker_ = std::thread(&CacheWarmer::run, this);
+}
+
+void CacheWarmer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+WarmupStats CacheWarmer::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+void CacheWarmer::run() {
+    int failedAttempts = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        lock.unlock();
+        WarmupStats stats = warmOnce();
+        if (!stats.succeeded) failedAttempts++;
+        stats.failedAttempts = failedAttempts;
+
+        if (stats.succeeded) {
+            std::cout << "Cache warm-up finished in " << stats.durationMs << " ms: "
+                      << stats.teams << " teams, " << stats.reviewers << " reviewers, "
+                      << stats.memberRows + stats.reviewRows << " rows" << std::endl;
+        } else {
+            std::cerr << "Warning: cache warm-up failed after " << stats.durationMs
+                      << " ms, retrying in " << retryInterval_.count() << " ms" << std::endl;
+        }
+        {
+            std::lock_guard<std::mutex> statsLock(statsMutex_);
+            stats_ = stats;
+        }
+        lock.lock();
+        if (stats.succeeded) {
+            ready_ = true;
+            break;
+        }
+        wakeup_.wait_for(lock, retryInterval_, [this] { return stopping_; });
+    }
+}
+
+WarmupStats CacheWarmer::warmOnce() {
+    auto start = std::chrono::steady_clock::now();
+    WarmupStats stats;
+    cache_.beginWarmup();
+
+    std::thread rosterLoader([this, &stats]() {
+        stats.memberRows = database_.streamTeamRosters([this, &stats](Team&& team) {
+            cache_.putTeamFromWarmup(team);
+            stats.teams++;
+        });
+    });
+
+    stats.reviewRows = database_.streamReviewAssignments(
+        [this, &stats](const std::string& reviewerId, std::vector<PullRequest>&& prs) {
+            for (const auto& pr : prs) {
+                if (!pr.isMerged()) stats.openReviews++;
+            }
+            cache_.putReviewsFromWarmup(reviewerId, std::move(prs));
+            stats.reviewers++;
+        });
+
+    rosterLoader.join();
+
+    stats.durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    stats.succeeded = stats.memberRows >= 0 && stats.reviewRows >= 0;
+    return stats;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "../database/Database.h"
+#include "../cache/ReviewCache.h"
+
+struct WarmupStats {
+    long long teams = 0;
+    long long memberRows = 0;
+    long long reviewers = 0;
+    long long reviewRows = 0;
+    long long openReviews = 0;
+    long long durationMs = 0;
+    bool succeeded = false;
+    int failedAttempts = 0;
+};
+
+// A failed warm-up is retried every retryInterval; the node only reports
+// ready once one has succeeded.
+class CacheWarmer {
+public:
+    CacheWarmer(Database& db, ReviewCache& cache,
+                std::chrono::milliseconds retryInterval = std::chrono::milliseconds(5000))
+        : database_(db), cache_(cache), retryInterval_(retryInterval) {}
+    ~CacheWarmer();
+
+    void start();
+    // Abandons pending retries and waits for the current attempt.
+    void stop();
+    bool isReady() const { return ready_; }
+    WarmupStats stats() const;
+
+private:
+    Database& database_;
+    ReviewCache& cache_;
+    std::chrono::milliseconds retryInterval_;
+
+    std::thread worker_;
+    std::atomic<bool> ready_{false};
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_ = false;
+    mutable std::mutex statsMutex_;
+    WarmupStats stats_;
+
+    void run();
+    WarmupStats warmOnce();
+};
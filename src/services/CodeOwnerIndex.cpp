@@ -0,0 +1,154 @@
+#include "CodeOwnerIndex.h"
+#include <chrono>
+#include "../database/Database.h"
+
+CodeOwnerIndex::CodeOwnerIndex(const std::vector<CodeOwnerRule>& rules) {
+    for (const auto& rule : rules) {
+        insert(normalize(rule.pattern), rule.owners);
+    }
+}
+
+// "/src/db/**" -> "src/db", "*" and "/" -> "" (the root).
+std::string_view CodeOwnerIndex::normalize(std::string_view pattern) {
+    while (!pattern.empty() && pattern.front() == '/') pattern.remove_prefix(1);
+    for (std::string_view suffix : {"/**", "/*"}) {
+        if (pattern.size() >= suffix.size() &&
+            pattern.compare(pattern.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            pattern.remove_suffix(suffix.size());
+        }
+    }
+    while (!pattern.empty() && pattern.back() == '/') pattern.remove_suffix(1);
+    if (pattern == "*" || pattern == "**") return {};
+    return pattern;
+}
+
+std::string_view CodeOwnerIndex::firstSegment(std::string_view path) {
+    return path.substr(0, path.find('/'));
+}
+
+// Length of the longest common prefix of a and b that ends on a segment boundary.
+size_t CodeOwnerIndex::commonSegments(std::string_view a, std::string_view b) {
+    size_t common = 0;
+    size_t i = 0;
+    while (i < a.size() && i < b.size() && a[i] == b[i]) {
+        i++;
+        if ((i == a.size() || a[i] == '/') && (i == b.size() || b[i] == '/')) {
+            common = i;
+        }
+    }
+    return common;
+}
+
+void CodeOwnerIndex::insert(std::string_view path, const std::vector<std::string>& owners) {
+    Node* node = &root_;
+    while (!path.empty()) {
+        auto it = node->children.find(firstSegment(path));
+        if (it == node->children.end()) {
+            auto child = std::make_unique<Node>();
+            child->label = std::string(path);
+            Node* inserted = child.get();
+            node->children.emplace(std::string(firstSegment(path)), std::move(child));
+            nodeCount_++;
+            node = inserted;
+            break;
+        }
+
+        Node* child = it->second.get();
+        size_t common = commonSegments(child->label, path);
+        if (common < child->label.size()) {
+            // Split the edge: parent keeps the shared segments, the old child
+            // hangs below it with the remainder of its label.
+            auto split = std::make_unique<Node>();
+            split->label = child->label.substr(0, common);
+            std::unique_ptr<Node> old = std::move(it->second);
+            old->label.erase(0, common + 1);
+            split->children.emplace(std::string(firstSegment(old->label)), std::move(old));
+            it->second = std::move(split);
+            child = it->second.get();
+            nodeCount_++;
+        }
+        node = child;
+        path.remove_prefix(std::min(path.size(), common + 1));
+    }
+
+    if (!node->hasRule) {
+        ruleCount_++;
+    }
+    node->hasRule = true;
+    node->owners = owners;
+}
+
+const std::vector<std::string>* CodeOwnerIndex::ownersOf(std::string_view path) const {
+    while (!path.empty() && path.front() == '/') path.remove_prefix(1);
+
+    const Node* node = &root_;
+    const std::vector<std::string>* owners = root_.hasRule ? &root_.owners : nullptr;
+    while (!path.empty()) {
+        auto it = node->children.find(firstSegment(path));
+        if (it == node->children.end()) break;
+
+        const std::string& label = it->second->label;
+        if (path.compare(0, label.size(), label) != 0 ||
+            (path.size() > label.size() && path[label.size()] != '/')) {
+            break;
+        }
+        node = it->second.get();
+        if (node->hasRule) {
+            owners = &node->owners;
+        }
+        path.remove_prefix(std::min(path.size(), label.size() + 1));
+    }
+    return owners;
+}
+
+bool CodeOwnerRegistry::reload(Database& db) {
+    std::vector<CodeOwnerRule> rules;
+    if (!db.getCodeOwnerRules(rules)) {
+        return false;
+    }
+    replace(rules);
+    return true;
+}
+
+void CodeOwnerRegistry::replace(const std::vector<CodeOwnerRule>& rules) {
+    std::lock_guard<std::mutex> lock(reloadMutex_);
+    auto start = std::chrono::steady_clock::now();
+    auto index = std::make_shared<const CodeOwnerIndex>(rules);
+    std::atomic_store(&index_, std::move(index));
+    lastReloadMs_ = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    reloads_++;
+}
+
+std::shared_ptr<const CodeOwnerIndex> CodeOwnerRegistry::snapshot() const {
+    return std::atomic_load(&index_);
+}
+
+std::unordered_map<std::string, int> CodeOwnerRegistry::matchOwners(const std::vector<std::string>& paths) {
+    auto index = snapshot();
+    std::unordered_map<std::string, int> matches;
+    uint64_t matched = 0;
+    for (const auto& path : paths) {
+        const auto* owners = index->ownersOf(path);
+        if (!owners) continue;
+        matched++;
+        for (const auto& owner : *owners) {
+            matches[owner]++;
+        }
+    }
+    pathsLooked_ += paths.size();
+    pathsMatched_ += matched;
+    return matches;
+}
+
+CodeOwnerStats CodeOwnerRegistry::stats() const {
+    auto index = snapshot();
+    CodeOwnerStats stats;
+    stats.rules = index->ruleCount();
+    stats.nodes = index->nodeCount();
+    stats.reloads = reloads_;
+    stats.lastReloadMs = lastReloadMs_;
+    stats.pathsLooked = pathsLooked_;
+    stats.pathsMatched = pathsMatched_;
+    return stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../models/CodeOwnerRule.h"
+
+class Database;
+
+// Immutable path trie over CODEOWNERS-style rules. A pattern owns a file or a
+// directory and everything below it ("src/database/", "/docs", "*" for the
+// whole tree). Edges are compressed runs of path segments, so a lookup costs
+// one map probe per branching directory. The most specific matching pattern
+// wins; when a pattern repeats, the later rule replaces the earlier one.
+class CodeOwnerIndex {
+public:
+    explicit CodeOwnerIndex(const std::vector<CodeOwnerRule>& rules);
+
+    // Owners of the most specific rule covering path, or nullptr.
+    const std::vector<std::string>* ownersOf(std::string_view path) const;
+
+    size_t ruleCount() const { return ruleCount_; }
+    size_t nodeCount() const { return nodeCount_; }
+
+private:
+    struct Node {
+        std::string label;
+        std::map<std::string, std::unique_ptr<Node>, std::less<>> children;
+        std::vector<std::string> owners;
+        bool hasRule = false;
+    };
+
+    Node root_;
+    size_t ruleCount_ = 0;
+    size_t nodeCount_ = 1;
+
+    void insert(std::string_view path, const std::vector<std::string>& owners);
+    static std::string_view normalize(std::string_view pattern);
+    static std::string_view firstSegment(std::string_view path);
+    static size_t commonSegments(std::string_view a, std::string_view b);
+};
+
+struct CodeOwnerStats {
+    size_t rules = 0;
+    size_t nodes = 0;
+    uint64_t reloads = 0;
+    double lastReloadMs = 0;
+    uint64_t pathsLooked = 0;
+    uint64_t pathsMatched = 0;
+};
+
+// Holds the current index. Reload builds a new trie off to the side and
+// swaps the pointer; requests keep the snapshot they started with.
+class CodeOwnerRegistry {
+public:
+    bool reload(Database& db);
+    void replace(const std::vector<CodeOwnerRule>& rules);
+    std::shared_ptr<const CodeOwnerIndex> snapshot() const;
+
+    // Number of changed paths each owner covers.
+    std::unordered_map<std::string, int> matchOwners(const std::vector<std::string>& paths);
+
+    CodeOwnerStats stats() const;
+
+private:
+    std::shared_ptr<const CodeOwnerIndex> index_ = std::make_shared<const CodeOwnerIndex>(
+        std::vector<CodeOwnerRule>());
+    std::mutex reloadMutex_;
+    std::atomic<uint64_t> reloads_{0};
+    std::atomic<double> lastReloadMs_{0};
+    std::atomic<uint64_t> pathsLooked_{0};
+    std::atomic<uint64_t> pathsMatched_{0};
+};
@@ -0,0 +1,244 @@
+#include "ColumnarExporter.h"
+#include "../database/RowDecoder.h"
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+struct TableSpec {
+    const char* name;
+    // $1 is the last key of the previous page, $2 the page size.
+    const char* query;
+    std::vector<std::pair<std::string, ColumnarExporter::ColumnType>> columns;
+    bool integerKey;
+};
+
+const std::vector<TableSpec>& tableSpecs() {
+    using Type = ColumnarExporter::ColumnType;
+    static const std::vector<TableSpec> specs = {
+        {"pull_requests",
+         "SELECT id, name, author_id, status, created_at, merged_at, archived "
+         "FROM pull_requests WHERE id > $1 ORDER BY id LIMIT $2::int",
+         {{"id", Type::UTF8}, {"name", Type::UTF8}, {"author_id", Type::DICT}, {"status", Type::DICT},
+          {"created_at", Type::TIMESTAMP}, {"merged_at", Type::TIMESTAMP}, {"archived", Type::BOOL}},
+         false},
+        {"pr_reviewers",
+         "SELECT id::bigint, pr_id, reviewer_id, assigned_at, archived "
+         "FROM pr_reviewers WHERE id > $1::bigint ORDER BY id LIMIT $2::int",
+         {{"id", Type::INT64}, {"pr_id", Type::UTF8}, {"reviewer_id", Type::DICT},
+          {"assigned_at", Type::TIMESTAMP}, {"archived", Type::BOOL}},
+         true},
+    };
+    return specs;
+}
+
+void appendU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out += static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+void appendU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out += static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+}
+
+ExportStats ColumnarExporter::exportTable(const std::string& table, std::ostream& out) {
+    const TableSpec* spec = nullptr;
+    for (const auto& candidate : tableSpecs()) {
+        if (table == candidate.name) spec = &candidate;
+    }
+    if (!spec) {
+        throw std::runtime_error("Unknown export table: " + table);
+    }
+
+    // Every shard is connected before anything is written.
+    std::vector<PGconn*> connections;
+    auto closeAll = [&connections]() {
+        for (PGconn* conn : connections) PQfinish(conn);
+    };
+    for (size_t shard = 0; shard < connectionStrings_.size(); shard++) {
+        connections.push_back(PQconnectdb(connectionStrings_[shard].c_str()));
+        if (PQstatus(connections.back()) != CONNECTION_OK || !RowDecoder::useUtc(connections.back())) {
+            std::string error = PQerrorMessage(connections.back());
+            closeAll();
+            throw std::runtime_error("Export connection to shard " + std::to_string(shard) + " failed: " + error);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto startPos = out.tellp();
+    ExportStats stats;
+
+    std::vector<Column> columns;
+    for (const auto& [name, type] : spec->columns) {
+        columns.emplace_back(name, type);
+    }
+    ArrowStreamWriter writer(out);
+    writeHeader(writer, columns);
+
+    std::string pageSize = std::to_string(batchRows_);
+    for (PGconn* conn : connections) {
+        std::string lastKey = spec->integerKey ? "0" : "";
+        while (true) {
+            const char* params[2] = { lastKey.c_str(), pageSize.c_str() };
+            PGresult* res = PQexecParams(conn, spec->query, 2, nullptr, params, nullptr, nullptr,
+                                         RowDecoder::BINARY);
+            if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+                std::string error = PQresultErrorMessage(res);
+                PQclear(res);
+                closeAll();
+                throw std::runtime_error("Export query failed: " + error);
+            }
+
+            int rows = PQntuples(res);
+            for (int i = 0; i < rows; i++) {
+                for (size_t col = 0; col < columns.size(); col++) {
+                    appendValue(columns[col], res, i, static_cast<int>(col));
+                }
+            }
+            if (rows > 0) {
+                RowDecoder last(res, rows - 1);
+                lastKey = spec->integerKey ? std::to_string(last.integer(0)) : last.text(0);
+                writeBatch(writer, columns, rows);
+                stats.rows += rows;
+                stats.batches++;
+            }
+            PQclear(res);
+
+            if (!out) {
+                closeAll();
+                throw std::runtime_error("Failed to write export output");
+            }
+            if (rows < batchRows_) break;
+        }
+    }
+    closeAll();
+
+    writer.writeEnd();
+    out.flush();
+
+    if (startPos != std::streampos(-1)) {
+        stats.bytes = static_cast<long long>(out.tellp() - startPos);
+    }
+    stats.durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void ColumnarExporter::appendValue(Column& column, const PGresult* res, int row, int col) {
+    RowDecoder decoder(res, row);
+    if (row % 8 == 0) column.validity += '\0';
+    bool present = !decoder.isNull(col);
+    if (present) {
+        column.validity.back() |= 1 << (row % 8);
+    } else {
+        column.nullCount++;
+    }
+
+    switch (column.type) {
+        case ColumnType::UTF8:
+            if (column.offsets.empty()) appendU32(column.offsets, 0);
+            if (present) column.data.append(PQgetvalue(res, row, col), PQgetlength(res, row, col));
+            appendU32(column.offsets, static_cast<uint32_t>(column.data.size()));
+            break;
+        case ColumnType::DICT: {
+            uint32_t index = 0;
+            if (present) {
+                std::string value = decoder.text(col);
+                auto it = column.dictionary.find(value);
+                if (it == column.dictionary.end()) {
+                    index = static_cast<uint32_t>(column.dictionary.size());
+                    column.dictionary.emplace(value, index);
+                    column.pendingEntries.push_back(std::move(value));
+                } else {
+                    index = it->second;
+                }
+            }
+            appendU32(column.offsets, index);
+            break;
+        }
+        case ColumnType::INT64:
+            appendU64(column.offsets, static_cast<uint64_t>(present ? decoder.integer(col) : 0));
+            break;
+        case ColumnType::TIMESTAMP:
+            appendU64(column.offsets, static_cast<uint64_t>(present
+                ? std::chrono::duration_cast<std::chrono::microseconds>(
+                      decoder.timestamp(col).time_since_epoch()).count()
+                : 0));
+            break;
+        case ColumnType::BOOL:
+            if (row % 8 == 0) column.offsets += '\0';
+            if (decoder.boolean(col)) column.offsets.back() |= 1 << (row % 8);
+            break;
+    }
+}
+
+void ColumnarExporter::writeHeader(ArrowStreamWriter& writer, const std::vector<Column>& columns) {
+    std::vector<ArrowStreamWriter::Field> fields;
+    for (size_t col = 0; col < columns.size(); col++) {
+        ArrowStreamWriter::Field field;
+        field.name = columns[col].name;
+        switch (columns[col].type) {
+            case ColumnType::UTF8: field.type = ArrowStreamWriter::Type::UTF8; break;
+            case ColumnType::DICT:
+                field.type = ArrowStreamWriter::Type::UTF8;
+                field.dictionaryId = static_cast<int64_t>(col);
+                break;
+            case ColumnType::INT64: field.type = ArrowStreamWriter::Type::INT64; break;
+            case ColumnType::TIMESTAMP: field.type = ArrowStreamWriter::Type::TIMESTAMP_MICROS; break;
+            case ColumnType::BOOL: field.type = ArrowStreamWriter::Type::BOOL; break;
+        }
+        fields.push_back(field);
+    }
+    writer.writeSchema(fields);
+
+    // Readers expect every dictionary before the first batch; entries
+    // follow as deltas.
+    std::string emptyOffsets;
+    appendU32(emptyOffsets, 0);
+    for (size_t col = 0; col < columns.size(); col++) {
+        if (columns[col].type != ColumnType::DICT) continue;
+        writer.writeDictionary(static_cast<int64_t>(col), {0, 0, {std::string_view(), emptyOffsets, std::string_view()}},
+                               false);
+    }
+}
+
+void ColumnarExporter::writeBatch(ArrowStreamWriter& writer, std::vector<Column>& columns, uint32_t rows) {
+    for (size_t col = 0; col < columns.size(); col++) {
+        Column& column = columns[col];
+        if (column.pendingEntries.empty()) continue;
+        std::string offsets;
+        std::string data;
+        appendU32(offsets, 0);
+        for (const auto& entry : column.pendingEntries) {
+            data += entry;
+            appendU32(offsets, static_cast<uint32_t>(data.size()));
+        }
+        writer.writeDictionary(static_cast<int64_t>(col),
+                               {static_cast<int64_t>(column.pendingEntries.size()), 0,
+                                {std::string_view(), offsets, data}},
+                               true);
+        column.pendingEntries.clear();
+    }
+
+    std::vector<ArrowStreamWriter::Array> arrays;
+    for (const Column& column : columns) {
+        ArrowStreamWriter::Array array;
+        array.length = rows;
+        array.nullCount = column.nullCount;
+        array.buffers.push_back(column.validity);
+        array.buffers.push_back(column.offsets);
+        if (column.type == ColumnType::UTF8) {
+            array.buffers.push_back(column.data);
+        }
+        arrays.push_back(std::move(array));
+    }
+    writer.writeRecordBatch(rows, arrays);
+
+    for (Column& column : columns) {
+        column.validity.clear();
+        column.nullCount = 0;
+        column.offsets.clear();
+        column.data.clear();
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <libpq-fe.h>
+#include "ArrowStreamWriter.h"
+
+struct ExportStats {
+    long long rows = 0;
+    long long batches = 0;
+    long long bytes = 0;
+    long long durationMs = 0;
+};
+
+// Streams pull_requests or pr_reviewers as an Arrow IPC stream. Rows are read
+// in keyset-paginated pages, each its own short statement, so the export holds
+// no long transaction and memory stays at one batch plus the dictionaries.
+// With several shards they are read one after another into the same stream;
+// rows are ordered by key within a shard only.
+//
+// The stream holds the schema, an empty dictionary per DICT column, then per
+// page the new dictionary entries (delta batches) and one record batch. DICT
+// columns are dictionary<int32, utf8>; TIMESTAMP is timestamp[us] without a
+// time zone, as stored.
+class ColumnarExporter {
+public:
+    enum class ColumnType : uint8_t {
+        UTF8 = 0,
+        DICT = 1,
+        INT64 = 2,
+        TIMESTAMP = 3,
+        BOOL = 4
+    };
+
+    // One connection string per shard, in shard order.
+    explicit ColumnarExporter(std::vector<std::string> connectionStrings, int batchRows = 65536)
+        : connectionStrings_(std::move(connectionStrings)), batchRows_(batchRows) {}
+
+    ExportStats exportTable(const std::string& table, std::ostream& out);
+
+private:
+    struct Column {
+        std::string name;
+        ColumnType type;
+        std::string validity;
+        int64_t nullCount = 0;
+        // UTF8 offsets; DICT, INT64 and TIMESTAMP values; the BOOL bitmap.
+        std::string offsets;
+        std::string data;
+        std::unordered_map<std::string, uint32_t> dictionary;
+        std::vector<std::string> pendingEntries;
+
+        Column(const std::string& name, ColumnType type) : name(name), type(type) {}
+    };
+
+    std::vector<std::string> connectionStrings_;
+    int batchRows_;
+
+    void appendValue(Column& column, const PGresult* res, int row, int col);
+    void writeHeader(ArrowStreamWriter& writer, const std::vector<Column>& columns);
+    void writeBatch(ArrowStreamWriter& writer, std::vector<Column>& columns, uint32_t rows);
+};
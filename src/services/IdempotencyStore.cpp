@@ -0,0 +1,156 @@
+#include "IdempotencyStore.h"
+#include <cstdio>
+#include <iostream>
+
+namespace {
+const uint64_t PURGE_EVERY = 1024;
+}
+
+IdempotencyStore::IdempotencyStore(size_t capacity, std::chrono::seconds ttl,
+                                   std::chrono::seconds claimLease)
+    : responses_(capacity), ttl_(ttl), claimLease_(claimLease) {}
+
+IdempotencyStore::Outcome IdempotencyStore::begin(const std::string& key, const std::string& fingerprint,
+                                                  IdempotentResponse& replay) {
+    auto stored = responses_.get(key);
+    if (stored && std::chrono::steady_clock::now() - stored->storedAt < ttl_) {
+        return replayOrMismatch(*stored, fingerprint, replay);
+    }
+
+    bool purge = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = inFlight_.find(key);
+        if (it != inFlight_.end()) {
+            if (it->second != fingerprint) {
+                mismatches_++;
+                return Outcome::MISMATCH;
+            }
+            conflicts_++;
+            return Outcome::IN_PROGRESS;
+        }
+        inFlight_[key] = fingerprint;
+        purge = database_ && ++begins_ % PURGE_EVERY == 0;
+    }
+
+    if (!database_) {
+        return Outcome::PROCEED;
+    }
+
+    if (purge) {
+        database_->purgeIdempotencyKeys(static_cast<int>(ttl_.count()));
+    }
+
+    int claimed = database_->claimIdempotencyKey(key, fingerprint, static_cast<int>(claimLease_.count()));
+    if (claimed > 0) {
+        return Outcome::PROCEED;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_.erase(key);
+    }
+    if (claimed < 0) {
+        failures_++;
+        return Outcome::UNAVAILABLE;
+    }
+
+    auto record = database_->getIdempotencyRecord(key);
+    if (!record || record->isInProgress()) {
+        if (record && record->fingerprint != fingerprint) {
+            mismatches_++;
+            return Outcome::MISMATCH;
+        }
+        conflicts_++;
+        return Outcome::IN_PROGRESS;
+    }
+
+    IdempotentResponse remote;
+    remote.status = record->status;
+    remote.body = record->body;
+    remote.fingerprint = record->fingerprint;
+    remote.storedAt = std::chrono::steady_clock::now();
+    responses_.put(key, remote);
+    return replayOrMismatch(remote, fingerprint, replay);
+}
+
+void IdempotencyStore::complete(const std::string& key, int status, const std::string& body) {
+    std::string fingerprint;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = inFlight_.find(key);
+        if (it == inFlight_.end()) return;
+        fingerprint = it->second;
+    }
+
+    IdempotentResponse response;
+    response.status = status;
+    response.body = body;
+    response.fingerprint = fingerprint;
+    response.storedAt = std::chrono::steady_clock::now();
+    responses_.put(key, response);
+
+    if (database_ && !database_->saveIdempotencyRecord(IdempotencyRecord(key, fingerprint, status, body))) {
+        std::cerr << "Failed to persist idempotency key " << key << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    inFlight_.erase(key);
+}
+
+void IdempotencyStore::abandon(const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inFlight_.erase(key) == 0) return;
+    }
+    if (database_) {
+        database_->releaseIdempotencyKey(key);
+    }
+}
+
+IdempotencyStats IdempotencyStore::stats() const {
+    IdempotencyStats stats;
+    stats.entries = responses_.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.inFlight = inFlight_.size();
+    }
+    stats.replays = replays_;
+    stats.conflicts = conflicts_;
+    stats.mismatches = mismatches_;
+    stats.failures = failures_;
+    return stats;
+}
+
+std::string IdempotencyStore::fingerprint(const std::string& method, const std::string& url,
+                                          const std::string& body) {
+    // FNV-1a, so every node computes the same fingerprint for the same request.
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const std::string& part) {
+        for (unsigned char c : part) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+    };
+    mix(method);
+    mix(url);
+    mix(body);
+
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+IdempotencyStore::Outcome IdempotencyStore::replayOrMismatch(const IdempotentResponse& stored,
+                                                             const std::string& fingerprint,
+                                                             IdempotentResponse& replay) {
+    if (stored.fingerprint != fingerprint) {
+        mismatches_++;
+        return Outcome::MISMATCH;
+    }
+    replays_++;
+    replay = stored;
+    return Outcome::REPLAY;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "../cache/LruCache.h"
+#include "../database/Database.h"
+
+struct IdempotentResponse {
+    int status = 0;
+    std::string body;
+    std::string fingerprint;
+    std::chrono::steady_clock::time_point storedAt;
+};
+
+struct IdempotencyStats {
+    size_t entries = 0;
+    size_t inFlight = 0;
+    uint64_t replays = 0;
+    uint64_t conflicts = 0;
+    uint64_t mismatches = 0;
+    uint64_t failures = 0;
+};
+
+// Remembers responses of mutating requests by Idempotency-Key so a retried
+// request gets the original response instead of being applied twice. Responses
+// live in a bounded LRU; with a database attached, keys are also claimed in
+// Postgres so retries landing on another node are deduplicated too.
+class IdempotencyStore {
+public:
+    enum class Outcome {
+        PROCEED,
+        REPLAY,
+        IN_PROGRESS,
+        MISMATCH,
+        // The key could not be claimed in the database; the request must not
+        // run, but nothing is known about earlier attempts either.
+        UNAVAILABLE
+    };
+
+    IdempotencyStore(size_t capacity, std::chrono::seconds ttl,
+                     std::chrono::seconds claimLease = std::chrono::seconds(60));
+
+    void setDatabase(Database* db) { database_ = db; }
+    void coverRoute(const std::string& route) { routes_.insert(route); }
+    bool covers(const std::string& route) const { return routes_.count(route) > 0; }
+
+    Outcome begin(const std::string& key, const std::string& fingerprint, IdempotentResponse& replay);
+    void complete(const std::string& key, int status, const std::string& body);
+    void abandon(const std::string& key);
+
+    IdempotencyStats stats() const;
+
+    static std::string fingerprint(const std::string& method, const std::string& url,
+                                   const std::string& body);
+
+private:
+    LruCache<std::string, IdempotentResponse> responses_;
+    std::chrono::seconds ttl_;
+    std::chrono::seconds claimLease_;
+    Database* database_ = nullptr;
+    std::unordered_set<std::string> routes_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::string> inFlight_;
+    uint64_t begins_ = 0;
+
+    std::atomic<uint64_t> replays_{0};
+    std::atomic<uint64_t> conflicts_{0};
+    std::atomic<uint64_t> mismatches_{0};
+    std::atomic<uint64_t> failures_{0};
+
+    Outcome replayOrMismatch(const IdempotentResponse& stored, const std::string& fingerprint,
+                             IdempotentResponse& replay);
+};
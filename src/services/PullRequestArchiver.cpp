@@ -0,0 +1,58 @@
+#include "PullRequestArchiver.h"
+#include <iostream>
+
+PullRequestArchiver::~PullRequestArchiver() {
+    stop();
+}
+
+void PullRequestArchiver::start() {
+    if (worker_.joinable()) return;
+    stopping_ = false;
+    worker_ = std::thread(&PullRequestArchiver::run, this);
+}
+
+void PullRequestArchiver::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+int PullRequestArchiver::runOnce() {
+    int total = 0;
+    failedShards_ = 0;
+    for (int shard = 0; shard < database_.shardCount(); shard++) {
+        while (true) {
+            int archived = database_.archiveMergedPullRequests(shard, retentionDays_, batchSize_);
+            if (archived < 0) {
+                std::cerr << "Warning: PR archival batch failed on shard " << shard << std::endl;
+                failedShards_++;
+                break;
+            }
+            total += archived;
+            if (archived < batchSize_) break;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return total;
+        }
+    }
+    return total;
+}
+
+void PullRequestArchiver::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        lock.unlock();
+        int archived = runOnce();
+        if (archived > 0) {
+            std::cout << "Archived " << archived << " merged PRs older than "
+                      << retentionDays_ << " days" << std::endl;
+        }
+        lock.lock();
+        wakeup_.wait_for(lock, interval_, [this] { return stopping_; });
+    }
+}
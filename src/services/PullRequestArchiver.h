@@ -0,0 +1,35 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "../database/Database.h"
+
+class PullRequestArchiver {
+public:
+    PullRequestArchiver(Database& db, int retentionDays, std::chrono::seconds interval,
+                        int batchSize = 500)
+        : database_(db), retentionDays_(retentionDays), interval_(interval), batchSize_(batchSize) {}
+    ~PullRequestArchiver();
+
+    void start();
+    void stop();
+    // Archives every shard down to less than a full batch. A shard whose batch
+    // fails is skipped for the rest of the pass; the others still run.
+    int runOnce();
+    int lastFailedShards() const { return failedShards_; }
+
+private:
+    Database& database_;
+    int retentionDays_;
+    std::chrono::seconds interval_;
+    int batchSize_;
+    int failedShards_ = 0;
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_ = false;
+
+    void run();
+};
@@ -1,25 +1,62 @@
 #include "ReviewAssignmentService.h"
 
+void ReviewAssignmentService::seed(uint64_t value) {
+    std::lock_guard<std::mutex> lock(generatorMutex_);
+    generator_.seed(static_cast<std::mt19937::result_type>(value));
+}
+
+// Candidates come in database order, which is not stable; sorting first
+// keeps a seeded shuffle reproducible.
+void ReviewAssignmentService::shuffle(std::vector<User>& users) {
+    std::sort(users.begin(), users.end(), [](const User& a, const User& b) { return a.id < b.id; });
+    std::lock_guard<std::mutex> lock(generatorMutex_);
+    std::shuffle(users.begin(), users.end(), generator_);
+}
+
 std::vector<std::string> ReviewAssignmentService::assignReviewers(
-    const std::string& authorId, const std::string& teamName) {
+    const std::string& authorId, const std::string& teamName, const std::vector<std::string>& changedPaths) {
     
     auto candidates = database_.getActiveTeamMembers(teamName, authorId);
-    return selectRandomReviewers(candidates, 2);
+    if (!codeOwners_ || changedPaths.empty()) {
+        return selectRandomReviewers(candidates, 2);
+    }
+    
+    auto matches = codeOwners_->matchOwners(changedPaths);
+    std::vector<User> owners;
+    std::vector<User> others;
+    for (auto& candidate : candidates) {
+        (matches.count(candidate.id) ? owners : others).push_back(std::move(candidate));
+    }
+    
+    // Shuffle first so owners with equal coverage are picked at random.
+    shuffle(owners);
+    std::stable_sort(owners.begin(), owners.end(), [&matches](const User& a, const User& b) {
+        return matches[a.id] > matches[b.id];
+    });
+    
+    std::vector<std::string> selected;
+    for (size_t i = 0; i < owners.size() && selected.size() < 2; i++) {
+        selected.push_back(owners[i].id);
+    }
+    for (auto& reviewer : selectRandomReviewers(others, 2 - static_cast<int>(selected.size()))) {
+        selected.push_back(std::move(reviewer));
+    }
+    return selected;
 }
 
 std::string ReviewAssignmentService::reassignReviewer(
     const std::string& prId, const std::string& oldReviewerId) {
     
-    if (database_.isPRMerged(prId)) {
+    auto pr = lookups_.getPullRequest(prId);
+    if (pr && pr->isMerged()) {
         throw std::runtime_error("Cannot reassign reviewers for merged PR");
     }
     
-    auto oldReviewer = database_.getUser(oldReviewerId);
+    auto oldReviewer = lookups_.getUser(oldReviewerId);
     if (!oldReviewer) {
         throw std::runtime_error("Reviewer not found");
     }
     
-    auto pr = database_.getPullRequest(prId);
     if (!pr) {
         throw std::runtime_error("PR not found");
     }
@@ -51,7 +88,7 @@ std::vector<std::string> ReviewAssignmentService::selectRandomReviewers(
     }
     
     std::vector<User> available = candidates;
-    std::shuffle(available.begin(), available.end(), generator_);
+    shuffle(available);
     
     int toSelect = std::min(count, static_cast<int>(available.size()));
     for (int i = 0; i < toSelect; i++) {
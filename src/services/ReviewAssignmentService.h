@@ -3,21 +3,35 @@
 #include <string>
 #include <random>
 #include <algorithm>
+#include <mutex>
 #include <stdexcept>
 #include "../database/Database.h"
+#include "../database/LookupCoalescer.h"
+#include "CodeOwnerIndex.h"
 #include <User.h>
 
 class ReviewAssignmentService {
 public:
-    ReviewAssignmentService(Database& db) : database_(db) {}
+    ReviewAssignmentService(Database& db, LookupCoalescer& lookups) : database_(db), lookups_(lookups) {}
     
-    std::vector<std::string> assignReviewers(const std::string& authorId, const std::string& teamName);
+    void setCodeOwners(CodeOwnerRegistry* codeOwners) { codeOwners_ = codeOwners; }
+    // A fixed seed makes a replayed capture pick the same reviewers.
+    void seed(uint64_t value);
+    
+    // Teammates owning the most changed paths go first; remaining slots are
+    // filled at random.
+    std::vector<std::string> assignReviewers(const std::string& authorId, const std::string& teamName,
+                                             const std::vector<std::string>& changedPaths = {});
     std::string reassignReviewer(const std::string& prId, const std::string& oldReviewerId);
     
 private:
     Database& database_;
+    LookupCoalescer& lookups_;
+    CodeOwnerRegistry* codeOwners_ = nullptr;
     std::random_device random_device_;
     std::mt19937 generator_{random_device_()};
+    std::mutex generatorMutex_;
     
+    void shuffle(std::vector<User>& users);
     std::vector<std::string> selectRandomReviewers(const std::vector<User>& candidates, int count);
 };
\ No newline at end of file
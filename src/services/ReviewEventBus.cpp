@@ -0,0 +1,134 @@
+#include "ReviewEventBus.h"
+
+ReviewEventBus::~ReviewEventBus() {
+    stop();
+}
+
+void ReviewEventBus::start() {
+    if (dispatcher_.joinable()) return;
+    stopping_ = false;
+    dispatcher_ = std::thread(&ReviewEventBus::run, this);
+}
+
+void ReviewEventBus::stop(std::chrono::milliseconds flushFor) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        flushUntil_ = std::chrono::steady_clock::now() + flushFor;
+    }
+    wakeup_.notify_all();
+    if (dispatcher_.joinable()) {
+        dispatcher_.join();
+    }
+}
+
+uint64_t ReviewEventBus::subscribe(const std::string& userId, Sink sink) {
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->userId = userId;
+    subscriber->sink = std::move(sink);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t id = nextId_++;
+    subscribers_.emplace(id, std::move(subscriber));
+    byUser_.emplace(userId, id);
+    return id;
+}
+
+void ReviewEventBus::unsubscribe(uint64_t subscriptionId) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = subscribers_.find(subscriptionId);
+        if (it == subscribers_.end()) return;
+
+        auto range = byUser_.equal_range(it->second->userId);
+        for (auto userIt = range.first; userIt != range.second; ++userIt) {
+            if (userIt->second == subscriptionId) {
+                byUser_.erase(userIt);
+                break;
+            }
+        }
+        it->second->sink = nullptr;
+        subscribers_.erase(it);
+    }
+    // Wait out a delivery that may still be using the sink.
+    std::lock_guard<std::mutex> delivery(deliveryMutex_);
+}
+
+void ReviewEventBus::publish(const ReviewEvent& event) {
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto range = byUser_.equal_range(event.user_id);
+        for (auto it = range.first; it != range.second; ++it) {
+            auto& subscriber = subscribers_[it->second];
+            if (subscriber->queue.size() >= queueCapacity_) {
+                subscriber->queue.erase(subscriber->queue.begin());
+                subscriber->dropped++;
+                droppedTotal_++;
+            }
+            subscriber->queue.push_back(event);
+            if (!subscriber->ready) {
+                subscriber->ready = true;
+                ready_.push_back(subscriber);
+                notify = true;
+            }
+        }
+    }
+    if (notify) {
+        wakeup_.notify_one();
+    }
+}
+
+size_t ReviewEventBus::subscriberCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.size();
+}
+
+uint64_t ReviewEventBus::droppedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return droppedTotal_;
+}
+
+void ReviewEventBus::run() {
+    std::vector<std::shared_ptr<Subscriber>> batch;
+    std::vector<ReviewEvent> events;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeup_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+            if (stopping_ && ready_.empty()) return;
+            batch.swap(ready_);
+        }
+
+        for (auto& subscriber : batch) {
+            std::lock_guard<std::mutex> delivery(deliveryMutex_);
+            Sink sink;
+            uint64_t dropped = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stopping_ && std::chrono::steady_clock::now() >= flushUntil_) {
+                    droppedTotal_ += subscriber->queue.size();
+                    subscriber->queue.clear();
+                    subscriber->ready = false;
+                    continue;
+                }
+                events.swap(subscriber->queue);
+                dropped = subscriber->dropped;
+                subscriber->dropped = 0;
+                subscriber->ready = false;
+                sink = subscriber->sink;
+            }
+            if (sink) {
+                if (dropped > 0) {
+                    sink(ReviewEvent(ReviewEventType::RESYNC, subscriber->userId, ""));
+                }
+                for (const auto& event : events) {
+                    sink(event);
+                }
+            }
+            events.clear();
+        }
+        batch.clear();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../models/ReviewEvent.h"
+
+// In-process fan-out of review events to per-user subscribers. Each subscriber
+// owns a bounded queue; on overflow the oldest events are dropped and a RESYNC
+// event tells the client to refetch its review list.
+class ReviewEventBus {
+public:
+    using Sink = std::function<void(const ReviewEvent&)>;
+
+    explicit ReviewEventBus(size_t queueCapacity = 64) : queueCapacity_(queueCapacity) {}
+    ~ReviewEventBus();
+
+    void start();
+    // Events already queued are still delivered for up to flushFor; what is
+    // left after that counts as dropped.
+    void stop(std::chrono::milliseconds flushFor = std::chrono::milliseconds(0));
+
+    uint64_t subscribe(const std::string& userId, Sink sink);
+    void unsubscribe(uint64_t subscriptionId);
+    void publish(const ReviewEvent& event);
+
+    size_t subscriberCount() const;
+    uint64_t droppedCount() const;
+
+private:
+    struct Subscriber {
+        std::string userId;
+        Sink sink;
+        std::vector<ReviewEvent> queue;
+        uint64_t dropped = 0;
+        bool ready = false;
+    };
+
+    size_t queueCapacity_;
+    uint64_t nextId_ = 1;
+    uint64_t droppedTotal_ = 0;
+
+    std::unordered_map<uint64_t, std::shared_ptr<Subscriber>> subscribers_;
+    std::unordered_multimap<std::string, uint64_t> byUser_;
+    std::vector<std::shared_ptr<Subscriber>> ready_;
+
+    mutable std::mutex mutex_;
+    std::mutex deliveryMutex_;
+    std::condition_variable wakeup_;
+    std::thread dispatcher_;
+    bool stopping_ = false;
+    std::chrono::steady_clock::time_point flushUntil_;
+
+    void run();
+};
@@ -0,0 +1,67 @@
+#include "ShutdownCoordinator.h"
+#include <csignal>
+#include <pthread.h>
+
+namespace {
+
+sigset_t shutdownSignals() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    return signals;
+}
+
+}
+
+void ShutdownCoordinator::blockSignals() {
+    sigset_t signals = shutdownSignals();
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+}
+
+int ShutdownCoordinator::waitForSignal() {
+    sigset_t signals = shutdownSignals();
+    int signal = 0;
+    sigwait(&signals, &signal);
+    return signal;
+}
+
+bool ShutdownCoordinator::enter() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (draining_) {
+        rejected_++;
+        return false;
+    }
+    inFlight_++;
+    return true;
+}
+
+void ShutdownCoordinator::leave() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inFlight_--;
+    if (draining_) {
+        completedWhileDraining_++;
+        if (inFlight_ == 0) idle_.notify_all();
+    }
+}
+
+bool ShutdownCoordinator::isDraining() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return draining_;
+}
+
+DrainStats ShutdownCoordinator::drain(std::chrono::milliseconds deadline) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    draining_ = true;
+
+    DrainStats stats;
+    stats.inFlightAtStart = inFlight_;
+    idle_.wait_for(lock, deadline, [this] { return inFlight_ == 0; });
+    stats.abandoned = inFlight_;
+    stats.completed = completedWhileDraining_;
+    stats.rejected = rejected_;
+    stats.durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
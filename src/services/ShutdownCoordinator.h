@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+struct DrainStats {
+    int inFlightAtStart = 0;
+    int abandoned = 0;
+    uint64_t completed = 0;
+    uint64_t rejected = 0;
+    long long durationMs = 0;
+};
+
+// Tracks in-flight requests so SIGTERM can stop taking new work and wait for
+// the running requests, up to a deadline, before the server is torn down.
+class ShutdownCoordinator {
+public:
+    // SIGINT/SIGTERM must be blocked before any thread starts so that only
+    // waitForSignal() ever receives them.
+    static void blockSignals();
+    static int waitForSignal();
+
+    bool enter();
+    void leave();
+    bool isDraining() const;
+
+    DrainStats drain(std::chrono::milliseconds deadline);
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable idle_;
+    bool draining_ = false;
+    int inFlight_ = 0;
+    uint64_t completedWhileDraining_ = 0;
+    uint64_t rejected_ = 0;
+};
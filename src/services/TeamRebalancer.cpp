@@ -0,0 +1,101 @@
+#include "TeamRebalancer.h"
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+RebalancePlan TeamRebalancer::plan(const std::vector<PullRequest>& openPRs, const std::vector<User>& members) {
+    RebalancePlan plan;
+    plan.openPRs = static_cast<int>(openPRs.size());
+
+    std::unordered_map<std::string, bool> isActive;
+    for (const auto& member : members) {
+        isActive[member.id] = member.is_active;
+        if (member.is_active) {
+            plan.loadBefore[member.id] = 0;
+        }
+    }
+
+    // Movable slots per reviewer (indices into openPRs) and the users each PR
+    // can never be handed to.
+    std::unordered_map<std::string, std::vector<size_t>> slots;
+    std::vector<std::unordered_set<std::string>> blocked(openPRs.size());
+    for (size_t i = 0; i < openPRs.size(); i++) {
+        blocked[i].insert(openPRs[i].author_id);
+        for (const auto& reviewer : openPRs[i].assigned_reviewers) {
+            blocked[i].insert(reviewer);
+            auto it = isActive.find(reviewer);
+            if (it == isActive.end()) continue;
+            slots[reviewer].push_back(i);
+            if (it->second) {
+                plan.loadBefore[reviewer]++;
+            } else {
+                plan.stranded++;
+            }
+        }
+    }
+
+    std::map<std::string, int> load = plan.loadBefore;
+    std::set<std::pair<int, std::string>> byLoad;
+    for (const auto& [id, count] : load) {
+        byLoad.emplace(count, id);
+    }
+
+    std::vector<std::string> strandedDonors;
+    for (const auto& [id, active] : isActive) {
+        if (!active && !slots[id].empty()) {
+            strandedDonors.push_back(id);
+        }
+    }
+    std::sort(strandedDonors.begin(), strandedDonors.end());
+
+    // Moves one slot of donor to the least loaded eligible member, if that
+    // member is below maxReceiverLoad. Returns false when no slot can move.
+    auto moveOne = [&](const std::string& donor, int maxReceiverLoad) {
+        auto& donorSlots = slots[donor];
+        for (auto receiver = byLoad.begin(); receiver != byLoad.end(); ++receiver) {
+            if (receiver->first > maxReceiverLoad) break;
+            for (auto slot = donorSlots.begin(); slot != donorSlots.end(); ++slot) {
+                if (blocked[*slot].count(receiver->second)) continue;
+
+                std::string to = receiver->second;
+                blocked[*slot].insert(to);
+                plan.moves.emplace_back(openPRs[*slot].id, donor, to);
+                donorSlots.erase(slot);
+
+                byLoad.erase(receiver);
+                byLoad.emplace(++load[to], to);
+                if (isActive[donor]) {
+                    byLoad.erase({load[donor], donor});
+                    byLoad.emplace(--load[donor], donor);
+                }
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (const auto& donor : strandedDonors) {
+        while (!slots[donor].empty() && moveOne(donor, plan.openPRs)) {}
+    }
+
+    std::unordered_set<std::string> exhausted;
+    while (!byLoad.empty()) {
+        auto busiest = std::find_if(byLoad.rbegin(), byLoad.rend(), [&exhausted](const auto& entry) {
+            return !exhausted.count(entry.second);
+        });
+        if (busiest == byLoad.rend() || busiest->first - byLoad.begin()->first <= 1) break;
+
+        // A donor stuck on blocked PRs may get a receiver again once
+        // another donor's load drops.
+        std::string donor = busiest->second;
+        if (moveOne(donor, busiest->first - 2)) {
+            exhausted.clear();
+        } else {
+            exhausted.insert(donor);
+        }
+    }
+
+    plan.loadAfter = load;
+    return plan;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#include "../models/PullRequest.h"
+#include "../models/ReviewerMove.h"
+#include "../models/User.h"
+
+struct RebalancePlan {
+    std::vector<ReviewerMove> moves;
+    std::map<std::string, int> loadBefore;
+    std::map<std::string, int> loadAfter;
+    int openPRs = 0;
+    int stranded = 0;
+};
+
+// Plans how to even out open reviews across a team's active members. Slots
+// held by inactive members are moved first, then one slot at a time goes from
+// the busiest member to the least busy one until loads differ by at most one.
+// A member never receives a PR they wrote or already review, and a moved slot
+// is never moved again, so the plan applies as independent row updates.
+class TeamRebalancer {
+public:
+    static RebalancePlan plan(const std::vector<PullRequest>& openPRs, const std::vector<User>& members);
+};
@@ -0,0 +1,176 @@
+#include "WebhookDispatcher.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <curl/curl.h>
+
+namespace {
+
+size_t discardBody(void*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+}
+
+WebhookDispatcher::~WebhookDispatcher() {
+    stop();
+}
+
+void WebhookDispatcher::start() {
+    if (!workers_.empty() || targets_.empty()) return;
+    stopping_ = false;
+    for (int i = 0; i < options_.workers; i++) {
+        workers_.emplace_back(&WebhookDispatcher::run, this);
+    }
+}
+
+void WebhookDispatcher::stop(std::chrono::milliseconds flushFor) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        flushUntil_ = std::chrono::steady_clock::now() + flushFor;
+    }
+    wakeup_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+int WebhookDispatcher::backoffSeconds(int attempts) const {
+    int shift = std::min(attempts, 16);
+    long long delay = static_cast<long long>(options_.baseBackoffSeconds) << shift;
+    return static_cast<int>(std::min<long long>(delay, options_.maxBackoffSeconds));
+}
+
+std::string WebhookDispatcher::buildPayload(const std::vector<OutboxEntry>& entries) {
+    std::string payload = "{\"events\":[";
+    for (size_t i = 0; i < entries.size(); i++) {
+        const auto& entry = entries[i];
+        if (i > 0) payload += ',';
+        payload += "{\"id\":" + std::to_string(entry.id) + ",\"type\":";
+        appendJsonString(payload, entry.event_type);
+        payload += ",\"user_id\":";
+        appendJsonString(payload, entry.user_id);
+        payload += ",\"pull_request_id\":";
+        appendJsonString(payload, entry.pr_id);
+        payload += ",\"createdAt\":";
+        appendJsonString(payload, entry.created_at);
+        payload += '}';
+    }
+    payload += "]}";
+    return payload;
+}
+
+bool WebhookDispatcher::deliver(void* handle, const std::string& target, const std::string& payload) {
+    CURL* curl = static_cast<CURL*>(handle);
+    curl_easy_reset(curl);
+
+    struct curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+
+    curl_easy_setopt(curl, CURLOPT_URL, target.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(payload.size()));
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardBody);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, static_cast<long>(options_.requestTimeoutSeconds));
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+    CURLcode res = curl_easy_perform(curl);
+    long responseCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+    curl_slist_free_all(headers);
+
+    return res == CURLE_OK && responseCode >= 200 && responseCode < 300;
+}
+
+// Failures only touch this target's rows: they are retried with backoff, or
+// dead-lettered once they have used up their attempts.
+void WebhookDispatcher::deliverBatch(void* curl, const std::string& target,
+                                     const std::vector<OutboxEntry>& entries) {
+    if (deliver(curl, target, buildPayload(entries))) {
+        database_.completeOutboxEntries(entries);
+        delivered_ += entries.size();
+        return;
+    }
+    std::cerr << "Warning: webhook delivery to " << target << " failed" << std::endl;
+    failed_ += entries.size();
+
+    std::vector<OutboxEntry> retry;
+    std::vector<OutboxEntry> exhausted;
+    int attempts = 0;
+    for (const auto& entry : entries) {
+        if (entry.attempts + 1 >= options_.maxAttempts) {
+            exhausted.push_back(entry);
+        } else {
+            retry.push_back(entry);
+            attempts = std::max(attempts, entry.attempts);
+        }
+    }
+    if (!retry.empty()) {
+        database_.rescheduleOutboxEntries(retry, backoffSeconds(attempts));
+    }
+    if (!exhausted.empty() && database_.deadLetterOutboxEntries(exhausted)) {
+        std::cerr << "Warning: " << exhausted.size() << " webhook deliveries to " << target
+                  << " moved to dead letters" << std::endl;
+        deadLettered_ += exhausted.size();
+    }
+}
+
+void WebhookDispatcher::run() {
+    // One easy handle per worker keeps connections to each target alive.
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        std::cerr << "Webhook dispatcher: failed to initialise curl" << std::endl;
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_ || std::chrono::steady_clock::now() < flushUntil_) {
+        lock.unlock();
+        auto entries = database_.claimOutboxBatch(options_.batchSize, options_.leaseSeconds);
+
+        // Claims come back in id order, so each target still sees its
+        // events in order.
+        std::map<std::string, std::vector<OutboxEntry>> byTarget;
+        for (const auto& entry : entries) {
+            byTarget[entry.target].push_back(entry);
+        }
+        for (const auto& group : byTarget) {
+            deliverBatch(curl, group.first, group.second);
+        }
+
+        lock.lock();
+        if (stopping_ && entries.empty()) break;
+        if (!stopping_ && entries.size() < static_cast<size_t>(options_.batchSize)) {
+            wakeup_.wait_for(lock, options_.pollInterval, [this] { return stopping_; });
+        }
+    }
+    lock.unlock();
+    curl_easy_cleanup(curl);
+}
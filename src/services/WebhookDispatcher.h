@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../database/Database.h"
+
+struct WebhookDispatcherOptions {
+    int batchSize = 100;
+    int workers = 2;
+    int leaseSeconds = 30;
+    int requestTimeoutSeconds = 5;
+    int baseBackoffSeconds = 1;
+    int maxBackoffSeconds = 300;
+    // A delivery that fails this many times moves to the dead-letter table.
+    int maxAttempts = 10;
+    std::chrono::milliseconds pollInterval{500};
+};
+
+class WebhookDispatcher {
+public:
+    WebhookDispatcher(Database& db, std::vector<std::string> targets,
+                      WebhookDispatcherOptions options = {})
+        : database_(db), targets_(std::move(targets)), options_(options) {}
+    ~WebhookDispatcher();
+
+    void start();
+    // With flushFor > 0, workers keep delivering due entries until the outbox
+    // has none left or the time runs out.
+    void stop(std::chrono::milliseconds flushFor = std::chrono::milliseconds(0));
+
+    uint64_t deliveredCount() const { return delivered_; }
+    uint64_t failedCount() const { return failed_; }
+    uint64_t deadLetteredCount() const { return deadLettered_; }
+
+private:
+    Database& database_;
+    std::vector<std::string> targets_;
+    WebhookDispatcherOptions options_;
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_ = false;
+    std::chrono::steady_clock::time_point flushUntil_;
+
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> deadLettered_{0};
+
+    void run();
+    void deliverBatch(void* curl, const std::string& target, const std::vector<OutboxEntry>& entries);
+    bool deliver(void* curl, const std::string& target, const std::string& payload);
+    int backoffSeconds(int attempts) const;
+    static std::string buildPayload(const std::vector<OutboxEntry>& entries);
+};
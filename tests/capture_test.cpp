@@ -0,0 +1,144 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../src/capture/TrafficCapture.h"
+
+const std::string CAPTURE_PATH = "capture_test.bin";
+
+CapturedRequest makeRequest(uint64_t offsetUs, const std::string& path, const std::string& body,
+                            const std::string& idempotencyKey, const std::string& minLsn) {
+    CapturedRequest request;
+    request.offsetUs = offsetUs;
+    request.latencyUs = 1234;
+    request.status = 201;
+    request.method = "POST";
+    request.path = path;
+    request.query = "dry_run=true";
+    request.body = body;
+    request.idempotencyKey = idempotencyKey;
+    request.minLsn = minLsn;
+    return request;
+}
+
+void assertSame(const CapturedRequest& a, const CapturedRequest& b) {
+    assert(a.offsetUs == b.offsetUs);
+    assert(a.latencyUs == b.latencyUs);
+    assert(a.status == b.status);
+    assert(a.method == b.method);
+    assert(a.path == b.path);
+    assert(a.query == b.query);
+    assert(a.body == b.body);
+    assert(a.idempotencyKey == b.idempotencyKey);
+    assert(a.minLsn == b.minLsn);
+}
+
+std::vector<CapturedRequest> readAll(uint64_t expectedSeed) {
+    CaptureReader reader;
+    assert(reader.open(CAPTURE_PATH));
+    assert(reader.current() && reader.rngSeed() == expectedSeed);
+    std::vector<CapturedRequest> requests;
+    CapturedRequest request;
+    while (reader.next(request)) {
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+long fileSize() {
+    std::FILE* file = std::fopen(CAPTURE_PATH.c_str(), "rb");
+    assert(file);
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fclose(file);
+    return size;
+}
+
+int main() {
+    std::remove(CAPTURE_PATH.c_str());
+
+    // Test 1: Round trip, including headers and a body with binary bytes
+    std::vector<CapturedRequest> written = {
+        makeRequest(10, "/pullRequest/create", R"({"pull_request_id": "pr-1"})", "key-1", "0/16B3748"),
+        makeRequest(20, "/team/get", "", "", ""),
+        makeRequest(300000, "/users/setIsActive", std::string("a\0b\xff", 4), "", "0/16B3750"),
+    };
+    {
+        TrafficCapture capture(CAPTURE_PATH, 100, 42);
+        assert(capture.start());
+        for (auto request : written) {
+            capture.record(std::move(request));
+        }
+        capture.stop();
+        assert(capture.stats().recorded == written.size() && capture.stats().bytes == static_cast<uint64_t>(fileSize()));
+    }
+    std::vector<CapturedRequest> read = readAll(42);
+    assert(read.size() == written.size());
+    for (size_t i = 0; i < written.size(); i++) {
+        assertSame(read[i], written[i]);
+    }
+    std::cout << "Capture round trip passed\n";
+
+    // Test 2: A restart appends without a second header, and offsets carry on
+    {
+        TrafficCapture capture(CAPTURE_PATH, 100, 42);
+        assert(capture.start());
+        assert(capture.elapsedUs() >= 300000);
+        capture.record(makeRequest(capture.elapsedUs(), "/team/add", "{}", "key-2", ""));
+        capture.stop();
+    }
+    read = readAll(42);
+    assert(read.size() == written.size() + 1);
+    for (size_t i = 0; i < written.size(); i++) {
+        assertSame(read[i], written[i]);
+    }
+    assert(read.back().path == "/team/add" && read.back().idempotencyKey == "key-2");
+    assert(read.back().offsetUs >= 300000);
+    std::cout << "Capture append passed\n";
+
+    // Test 3: A record cut short by a crash is dropped before appending
+    long complete = fileSize();
+    assert(truncate(CAPTURE_PATH.c_str(), complete - 3) == 0);
+    assert(readAll(42).size() == written.size());
+    {
+        TrafficCapture capture(CAPTURE_PATH, 100, 42);
+        assert(capture.start());
+        capture.record(makeRequest(capture.elapsedUs(), "/team/deactivate", "", "", ""));
+        capture.stop();
+    }
+    read = readAll(42);
+    assert(read.size() == written.size() + 1 && read.back().path == "/team/deactivate");
+    std::cout << "Capture truncated tail passed\n";
+
+    // Test 4: Captures of the previous format are read, but not appended to
+    {
+        std::FILE* file = std::fopen(CAPTURE_PATH.c_str(), "wb");
+        const char oldFormat[] = {
+            'P', 'R', 'C', 'A', 'P', '0', '0', '1', 1, 7,
+            5, 9, static_cast<char>(200), 1, 3, 'G', 'E', 'T', 2, '/', 'x', 0, 0
+        };
+        std::fwrite(oldFormat, 1, sizeof(oldFormat), file);
+        std::fclose(file);
+    }
+    {
+        CaptureReader reader;
+        assert(reader.open(CAPTURE_PATH) && !reader.current() && reader.rngSeed() == 7);
+        CapturedRequest request;
+        request.idempotencyKey = "stale";
+        assert(reader.next(request));
+        assert(request.offsetUs == 5 && request.status == 200 && request.method == "GET" && request.path == "/x");
+        assert(request.idempotencyKey.empty() && request.minLsn.empty());
+        assert(!reader.next(request));
+    }
+    {
+        TrafficCapture capture(CAPTURE_PATH, 100, 7);
+        assert(!capture.start());
+    }
+    std::cout << "Capture previous format passed\n";
+
+    std::remove(CAPTURE_PATH.c_str());
+    std::cout << "All capture tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,323 @@
+// Re-drives a traffic capture (CAPTURE_FILE) against a running instance and
+// compares latency histograms of two runs.
+//
+//   replay run <capture> [--target URL] [--speed X] [--concurrency N] [--out FILE]
+//   replay diff <before.hist> <after.hist>
+//
+// --speed 1 keeps the original pacing, 10 plays ten times faster and 0 sends
+// as fast as possible. Idempotency-Key and X-Min-LSN are sent as captured; a
+// captured LSN only means something against the database it came from. Reviewer picks are only reproducible with
+// --concurrency 1 and a target started with the capture's REVIEWER_RNG_SEED
+// on a database in the same state as when the capture began.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+#include "../src/capture/TrafficCapture.h"
+
+namespace {
+
+// Log-linear buckets: exact below 8 us, then 8 buckets per power of two
+// (at most 12.5% wide).
+const size_t BUCKETS = 8 + 61 * 8;
+
+size_t bucketOf(uint64_t us) {
+    if (us < 8) return us;
+    int exponent = 63 - __builtin_clzll(us);
+    return (exponent - 2) * 8 + ((us >> (exponent - 3)) & 7);
+}
+
+uint64_t bucketValue(size_t bucket) {
+    if (bucket < 8) return bucket;
+    int exponent = static_cast<int>(bucket / 8) + 2;
+    return static_cast<uint64_t>(8 + bucket % 8) << (exponent - 3);
+}
+
+struct Histogram {
+    std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS, 0);
+    uint64_t total = 0;
+
+    void add(uint64_t us) {
+        counts[std::min(bucketOf(us), BUCKETS - 1)]++;
+        total++;
+    }
+
+    void merge(const Histogram& other) {
+        for (size_t i = 0; i < BUCKETS; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+    }
+
+    uint64_t percentile(double p) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p * (total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) return bucketValue(i);
+        }
+        return bucketValue(BUCKETS - 1);
+    }
+};
+
+using Histograms = std::map<std::string, Histogram>;
+
+// One line per non-empty bucket: "<route>\t<bucket>\t<count>".
+bool writeHistograms(const std::string& path, const Histograms& histograms) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    out << "# replay histogram v1\n";
+    for (const auto& [route, histogram] : histograms) {
+        for (size_t i = 0; i < BUCKETS; i++) {
+            if (histogram.counts[i] > 0) {
+                out << route << '\t' << i << '\t' << histogram.counts[i] << '\n';
+            }
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+bool readHistograms(const std::string& path, Histograms& histograms) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t first = line.find('\t');
+        size_t second = line.find('\t', first + 1);
+        if (first == std::string::npos || second == std::string::npos) return false;
+        size_t bucket = std::strtoull(line.c_str() + first + 1, nullptr, 10);
+        uint64_t count = std::strtoull(line.c_str() + second + 1, nullptr, 10);
+        if (bucket >= BUCKETS) return false;
+        Histogram& histogram = histograms[line.substr(0, first)];
+        histogram.counts[bucket] += count;
+        histogram.total += count;
+    }
+    return true;
+}
+
+void printSummary(const Histograms& histograms) {
+    std::printf("%-40s %8s %10s %10s %10s\n", "route", "count", "p50_us", "p90_us", "p99_us");
+    for (const auto& [route, histogram] : histograms) {
+        std::printf("%-40s %8llu %10llu %10llu %10llu\n", route.c_str(),
+                    static_cast<unsigned long long>(histogram.total),
+                    static_cast<unsigned long long>(histogram.percentile(0.5)),
+                    static_cast<unsigned long long>(histogram.percentile(0.9)),
+                    static_cast<unsigned long long>(histogram.percentile(0.99)));
+    }
+}
+
+size_t discardBody(char*, size_t size, size_t count, void*) {
+    return size * count;
+}
+
+struct WorkerResult {
+    Histograms histograms;
+    uint64_t failed = 0;
+    uint64_t statusMismatches = 0;
+    uint64_t maxLagUs = 0;
+};
+
+int run(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " run <capture> [--target URL] [--speed X] "
+                  << "[--concurrency N] [--out FILE]" << std::endl;
+        return 2;
+    }
+    std::string target = "http://localhost:8080";
+    double speed = 1.0;
+    int concurrency = 1;
+    std::string outPath;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--target") {
+            target = argv[i + 1];
+        } else if (option == "--speed") {
+            speed = std::atof(argv[i + 1]);
+        } else if (option == "--concurrency") {
+            concurrency = std::max(1, std::atoi(argv[i + 1]));
+        } else if (option == "--out") {
+            outPath = argv[i + 1];
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    CaptureReader reader;
+    if (!reader.open(argv[2])) {
+        std::cerr << "Cannot read capture " << argv[2] << std::endl;
+        return 1;
+    }
+    std::vector<CapturedRequest> requests;
+    CapturedRequest request;
+    while (reader.next(request)) {
+        requests.push_back(std::move(request));
+    }
+    // The writer appends in completion order; replay in arrival order.
+    std::stable_sort(requests.begin(), requests.end(),
+        [](const CapturedRequest& a, const CapturedRequest& b) { return a.offsetUs < b.offsetUs; });
+    std::cerr << "Replaying " << requests.size() << " requests";
+    if (reader.rngSeed() != 0) {
+        std::cerr << " (captured with REVIEWER_RNG_SEED=" << reader.rngSeed() << ")";
+    }
+    std::cerr << std::endl;
+    if (requests.empty()) return 0;
+
+    uint64_t firstOffset = requests.front().offsetUs;
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next{0};
+    std::vector<WorkerResult> results(concurrency);
+    std::vector<std::thread> workers;
+    for (int w = 0; w < concurrency; w++) {
+        workers.emplace_back([&, w]() {
+            WorkerResult& result = results[w];
+            CURL* curl = curl_easy_init();
+            for (size_t i = next++; i < requests.size(); i = next++) {
+                const CapturedRequest& captured = requests[i];
+                auto due = start;
+                if (speed > 0) {
+                    due += std::chrono::microseconds(
+                        static_cast<int64_t>((captured.offsetUs - firstOffset) / speed));
+                    std::this_thread::sleep_until(due);
+                }
+
+                std::string url = target + captured.path;
+                if (!captured.query.empty()) {
+                    url += "?" + captured.query;
+                }
+                curl_easy_reset(curl);
+                curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, captured.method.c_str());
+                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardBody);
+                struct curl_slist* headers = nullptr;
+                if (!captured.body.empty()) {
+                    headers = curl_slist_append(headers, "Content-Type: application/json");
+                    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, captured.body.c_str());
+                    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(captured.body.size()));
+                }
+                if (!captured.idempotencyKey.empty()) {
+                    headers = curl_slist_append(headers, ("Idempotency-Key: " + captured.idempotencyKey).c_str());
+                }
+                if (!captured.minLsn.empty()) {
+                    headers = curl_slist_append(headers, ("X-Min-LSN: " + captured.minLsn).c_str());
+                }
+                if (headers) {
+                    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+                }
+
+                auto sent = std::chrono::steady_clock::now();
+                if (speed > 0 && sent > due) {
+                    result.maxLagUs = std::max<uint64_t>(result.maxLagUs,
+                        std::chrono::duration_cast<std::chrono::microseconds>(sent - due).count());
+                }
+                CURLcode code = curl_easy_perform(curl);
+                auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - sent).count();
+                curl_slist_free_all(headers);
+
+                if (code != CURLE_OK) {
+                    result.failed++;
+                    continue;
+                }
+                long status = 0;
+                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+                if (status != captured.status) {
+                    result.statusMismatches++;
+                }
+                result.histograms[captured.method + " " + captured.path].add(latency);
+            }
+            curl_easy_cleanup(curl);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    WorkerResult total;
+    for (const auto& result : results) {
+        for (const auto& [route, histogram] : result.histograms) {
+            total.histograms[route].merge(histogram);
+        }
+        total.failed += result.failed;
+        total.statusMismatches += result.statusMismatches;
+        total.maxLagUs = std::max(total.maxLagUs, result.maxLagUs);
+    }
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printSummary(total.histograms);
+    std::cerr << "Done in " << elapsedMs << " ms: " << total.failed << " failed, "
+              << total.statusMismatches << " with a different status than captured, "
+              << "max dispatch lag " << total.maxLagUs << " us" << std::endl;
+    if (!outPath.empty() && !writeHistograms(outPath, total.histograms)) {
+        std::cerr << "Cannot write " << outPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int diff(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " diff <before.hist> <after.hist>" << std::endl;
+        return 2;
+    }
+    Histograms before;
+    Histograms after;
+    if (!readHistograms(argv[2], before) || !readHistograms(argv[3], after)) {
+        std::cerr << "Cannot read histograms" << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, bool> routes;
+    for (const auto& entry : before) routes[entry.first] = true;
+    for (const auto& entry : after) routes[entry.first] = true;
+
+    auto change = [](uint64_t a, uint64_t b) {
+        return a == 0 ? 0.0 : (static_cast<double>(b) - static_cast<double>(a)) * 100.0 / a;
+    };
+    std::printf("%-40s %8s %8s %27s %27s %27s\n", "route", "before", "after",
+                "p50_us (change)", "p90_us (change)", "p99_us (change)");
+    for (const auto& entry : routes) {
+        const Histogram& a = before[entry.first];
+        const Histogram& b = after[entry.first];
+        std::printf("%-40s %8llu %8llu", entry.first.c_str(),
+                    static_cast<unsigned long long>(a.total), static_cast<unsigned long long>(b.total));
+        for (double p : {0.5, 0.9, 0.99}) {
+            uint64_t pa = a.percentile(p);
+            uint64_t pb = b.percentile(p);
+            std::printf(" %9llu->%-9llu%+6.1f%%", static_cast<unsigned long long>(pa),
+                        static_cast<unsigned long long>(pb), change(pa, pb));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "run") {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        int rc = run(argc, argv);
+        curl_global_cleanup();
+        return rc;
+    }
+    if (command == "diff") {
+        return diff(argc, argv);
+    }
+    std::cerr << "Usage: " << argv[0] << " run <capture> [options] | diff <before.hist> <after.hist>" << std::endl;
+    return 2;
+}